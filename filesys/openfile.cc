@@ -28,6 +28,7 @@ OpenFile::OpenFile(int sector)
 { 
     hdr = new FileHeader();
     hdr->FetchFrom(sector);
+    hdrSector = sector;
     seekPosition = 0;
 }
 
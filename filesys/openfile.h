@@ -84,9 +84,12 @@ class OpenFile {
 					// file (this interface is simpler 
 					// than the UNIX idiom -- lseek to 
 					// end of file, tell, lseek back 
+
+    int HeaderSector() { return hdrSector; }	// which file this is
     
   private:
     FileHeader *hdr;			// Header for this file 
+    int hdrSector;			// where the header is on disk
     int seekPosition;			// Current position within the file
 };
 
@@ -30,6 +30,12 @@ static char *intLevelNames[] = { "off", "on"};
 static char *intTypeNames[] = { "timer", "disk", "console write", 
 			"console read", "network send", "network recv"};
 
+// Value of nextDue when there is nothing pending
+#define NoPendingInterrupt	0x7fffffff
+
+// Initial size of the pending interrupt heap; it doubles when full
+#define InitialPending		16
+
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
 // 	Initialize a hardware device interrupt that is to be scheduled 
@@ -48,6 +54,22 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
     arg = param;
     when = time;
     type = kind;
+    seq = 0;
+    next = NULL;
+}
+
+//----------------------------------------------------------------------
+// Earlier
+// 	Heap order for pending interrupts: by time, and interrupts
+//	scheduled for the same time in the order they were scheduled.
+//----------------------------------------------------------------------
+
+static bool
+Earlier(PendingInterrupt *a, PendingInterrupt *b)
+{
+    if (a->when != b->when)
+	return a->when < b->when;
+    return a->seq < b->seq;
 }
 
 //----------------------------------------------------------------------
@@ -60,7 +82,12 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, int param, int time,
 Interrupt::Interrupt()
 {
     level = IntOff;
-    pending = new List();
+    maxPending = InitialPending;
+    pending = new PendingInterrupt*[maxPending];
+    numPending = 0;
+    nextSeq = 0;
+    freeList = NULL;
+    nextDue = NoPendingInterrupt;
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
@@ -73,9 +100,16 @@ Interrupt::Interrupt()
 
 Interrupt::~Interrupt()
 {
-    while (!pending->IsEmpty())
-	delete pending->Remove();
-    delete pending;
+    PendingInterrupt *toFree;
+
+    while (numPending > 0)
+	delete pending[--numPending];
+    delete [] pending;
+    while (freeList != NULL) {
+	toFree = freeList;
+	freeList = freeList->next;
+	delete toFree;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -146,6 +180,11 @@ Interrupt::Enable()
 //	Two things can cause OneTick to be called:
 //		interrupts are re-enabled
 //		a user instruction is executed
+//
+//	Since this happens on every simulated instruction, we only look
+//	at the pending list once the clock reaches the time of the
+//	earliest pending interrupt (nextDue); before that, advancing the
+//	time is all there is to do.
 //----------------------------------------------------------------------
 void
 Interrupt::OneTick()
@@ -163,12 +202,14 @@ Interrupt::OneTick()
     DEBUG('i', "\n== Tick %d ==\n", stats->totalTicks);
 
 // check any pending interrupts are now ready to fire
-    ChangeLevel(IntOn, IntOff);		// first, turn off interrupts
+    if (stats->totalTicks >= nextDue) {
+	ChangeLevel(IntOn, IntOff);	// first, turn off interrupts
 					// (interrupt handlers run with
 					// interrupts disabled)
-    while (CheckIfDue(FALSE))		// check for pending interrupts
-	;
-    ChangeLevel(IntOff, IntOn);		// re-enable interrupts
+	while (CheckIfDue(FALSE))	// check for pending interrupts
+	    ;
+	ChangeLevel(IntOff, IntOn);	// re-enable interrupts
+    }
     if (yieldOnReturn) {		// if the timer device handler asked 
 					// for a context switch, ok to do it now
 	yieldOnReturn = FALSE;
@@ -203,6 +244,8 @@ Interrupt::YieldOnReturn()
 //	Since something has to be running in order to put a thread
 //	on the ready queue, the only thing to do is to advance 
 //	simulated time until the next scheduled hardware interrupt.
+//	The clock jumps straight to nextDue, without ticking through
+//	the time in between.
 //
 //	If there are no pending interrupts, stop.  There's nothing
 //	more for us to do.
@@ -212,7 +255,8 @@ Interrupt::Idle()
 {
     DEBUG('i', "Machine idling; checking for interrupts.\n");
     status = IdleMode;
-    if (CheckIfDue(TRUE)) {		// check for any pending interrupts
+    if (nextDue != NoPendingInterrupt && CheckIfDue(TRUE)) {
+					// check for any pending interrupts
     	while (CheckIfDue(FALSE))	// check for any other pending 
 	    ;				// interrupts
         yieldOnReturn = FALSE;		// since there's nothing in the
@@ -235,13 +279,18 @@ Interrupt::Idle()
 
 //----------------------------------------------------------------------
 // Interrupt::Halt
-// 	Shut down Nachos cleanly, printing out performance statistics.
+// 	Shut down Nachos cleanly, printing out performance statistics
+//	if they were asked for ("-stats").
 //----------------------------------------------------------------------
 void
 Interrupt::Halt()
 {
     //printf("Machine halting!\n\n");
     //stats->Print();
+    if (printStats) {
+	printf("Machine halting!\n\n");
+	stats->Print();
+    }
     Cleanup();     // Never returns.
 }
 
@@ -250,7 +299,8 @@ Interrupt::Halt()
 // 	Arrange for the CPU to be interrupted when simulated time
 //	reaches "now + when".
 //
-//	Implementation: just put it on a sorted list.
+//	Implementation: put it on a binary heap, taking the
+//	PendingInterrupt from the free list if there is one.
 //
 //	NOTE: the Nachos kernel should not call this routine directly.
 //	Instead, it is only called by the hardware device simulators.
@@ -265,13 +315,97 @@ void
 Interrupt::Schedule(VoidFunctionPtr handler, int arg, int fromNow, IntType type)
 {
     int when = stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg, when, type);
+    PendingInterrupt *toOccur;
 
     DEBUG('i', "Scheduling interrupt handler the %s at time = %d\n", 
 					intTypeNames[type], when);
     ASSERT(fromNow > 0);
 
-    pending->SortedInsert(toOccur, when);
+    if (freeList != NULL) {
+	toOccur = freeList;
+	freeList = freeList->next;
+	toOccur->handler = handler;
+	toOccur->arg = arg;
+	toOccur->when = when;
+	toOccur->type = type;
+    } else
+	toOccur = new PendingInterrupt(handler, arg, when, type);
+    toOccur->seq = nextSeq++;
+
+    HeapInsert(toOccur);
+    if (when < nextDue)
+	nextDue = when;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::HeapInsert
+// 	Put an interrupt on the pending heap, growing the heap if needed,
+//	and sift it up to its place.
+//----------------------------------------------------------------------
+void
+Interrupt::HeapInsert(PendingInterrupt *toOccur)
+{
+    int i, parent;
+
+    if (numPending == maxPending) {
+	PendingInterrupt **bigger = new PendingInterrupt*[maxPending * 2];
+
+	for (i = 0; i < numPending; i++)
+	    bigger[i] = pending[i];
+	delete [] pending;
+	pending = bigger;
+	maxPending *= 2;
+    }
+    for (i = numPending++; i > 0; i = parent) {
+	parent = (i - 1) / 2;
+	if (!Earlier(toOccur, pending[parent]))
+	    break;
+	pending[i] = pending[parent];
+    }
+    pending[i] = toOccur;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::HeapRemove
+// 	Take the earliest interrupt off the pending heap, moving the last
+//	element down from the top to fill the hole.
+//
+// Returns:
+//	The removed interrupt, NULL if nothing is pending.
+//----------------------------------------------------------------------
+PendingInterrupt *
+Interrupt::HeapRemove()
+{
+    PendingInterrupt *first, *last;
+    int i, child;
+
+    if (numPending == 0)
+	return NULL;
+    first = pending[0];
+    last = pending[--numPending];
+    for (i = 0; (child = 2 * i + 1) < numPending; i = child) {
+	if (child + 1 < numPending && Earlier(pending[child + 1], pending[child]))
+	    child++;
+	if (!Earlier(pending[child], last))
+	    break;
+	pending[i] = pending[child];
+    }
+    pending[i] = last;
+    return first;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::UpdateNextDue
+// 	Remember when the interrupt at the top of the pending heap is to
+//	occur.  Called whenever an interrupt is taken off the heap.
+//----------------------------------------------------------------------
+void
+Interrupt::UpdateNextDue()
+{
+    if (numPending == 0)
+	nextDue = NoPendingInterrupt;
+    else
+	nextDue = pending[0]->when;
 }
 
 //----------------------------------------------------------------------
@@ -297,26 +431,26 @@ Interrupt::CheckIfDue(bool advanceClock)
 					// to invoke an interrupt handler
     if (DebugIsEnabled('i'))
 	DumpState();
-    PendingInterrupt *toOccur = 
-		(PendingInterrupt *)pending->SortedRemove(&when);
+    PendingInterrupt *toOccur;
 
-    if (toOccur == NULL)		// no pending interrupts
+    if (numPending == 0)		// no pending interrupts
 	return FALSE;			
+    toOccur = pending[0];		// look at the earliest, but leave
+    when = toOccur->when;		// it on the heap for now
 
     if (advanceClock && when > stats->totalTicks) {	// advance the clock
 	stats->idleTicks += (when - stats->totalTicks);
 	stats->totalTicks = when;
-    } else if (when > stats->totalTicks) {	// not time yet, put it back
-	pending->SortedInsert(toOccur, when);
+    } else if (when > stats->totalTicks)	// not time yet
 	return FALSE;
-    }
 
 // Check if there is nothing more to do, and if so, quit
     if ((status == IdleMode) && (toOccur->type == TimerInt) 
-				&& pending->IsEmpty()) {
-	 pending->SortedInsert(toOccur, when);
+				&& numPending == 1)
 	 return FALSE;
-    }
+
+    (void) HeapRemove();
+    UpdateNextDue();			// the handler may schedule more
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n", 
 			intTypeNames[toOccur->type], toOccur->when);
@@ -331,7 +465,8 @@ Interrupt::CheckIfDue(bool advanceClock)
     (*(toOccur->handler))(toOccur->arg);	// call the interrupt handler
     status = old;				// restore the machine status
     inHandler = FALSE;
-    delete toOccur;
+    toOccur->next = freeList;			// recycle it
+    freeList = toOccur;
     return TRUE;
 }
 
@@ -354,16 +489,31 @@ PrintPending(int arg)
 // DumpState
 // 	Print the complete interrupt state - the status, and all interrupts
 //	that are scheduled to occur in the future.
+//
+//	The heap is only partially ordered, so we sort a copy of it to
+//	print the interrupts in the order they will fire.
 //----------------------------------------------------------------------
 
 void
 Interrupt::DumpState()
 {
+    PendingInterrupt **sorted = new PendingInterrupt*[maxPending];
+    PendingInterrupt *pend;
+    int i, j;
+
     printf("Time: %d, interrupts %s\n", stats->totalTicks, 
 					intLevelNames[level]);
     printf("Pending interrupts:\n");
     fflush(stdout);
-    pending->Mapcar(PrintPending);
+    for (i = 0; i < numPending; i++) {		// insertion sort
+	pend = pending[i];
+	for (j = i; j > 0 && Earlier(pend, sorted[j - 1]); j--)
+	    sorted[j] = sorted[j - 1];
+	sorted[j] = pend;
+    }
+    for (i = 0; i < numPending; i++)
+	PrintPending((int) sorted[i]);
+    delete [] sorted;
     printf("End of pending interrupts\n");
     fflush(stdout);
 }
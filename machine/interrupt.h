@@ -36,7 +36,7 @@
 #define INTERRUPT_H
 
 #include "copyright.h"
-#include "list.h"
+#include "utility.h"
 
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
@@ -67,6 +67,9 @@ class PendingInterrupt {
     int arg;                    // The argument to the function.
     int when;			// When the interrupt is supposed to fire
     IntType type;		// for debugging
+    int seq;			// order in which interrupts were scheduled,
+				// so that equal "when"s fire FIFO
+    PendingInterrupt *next;	// next free object, while on the free list
 };
 
 // The following class defines the data structures for the simulation
@@ -114,8 +117,17 @@ class Interrupt {
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
-    List *pending;		// the list of interrupts scheduled
-				// to occur in the future
+    PendingInterrupt **pending;	// the interrupts scheduled to occur in
+				// the future, kept as a binary heap
+				// ordered by (when, seq)
+    int numPending;		// number of interrupts in the heap
+    int maxPending;		// size of the heap array
+    int nextSeq;		// sequence number of the next interrupt
+    PendingInterrupt *freeList;	// recycled PendingInterrupts, so
+				// Schedule does not allocate each time
+    int nextDue;		// when the earliest pending interrupt is
+				// to occur; until then, OneTick has
+				// nothing to check
     bool inHandler;		// TRUE if we are running an interrupt handler
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
@@ -125,6 +137,10 @@ class Interrupt {
 
     bool CheckIfDue(bool advanceClock); // Check if an interrupt is supposed
 					// to occur now
+    void UpdateNextDue();		// Recompute nextDue from the pending
+					// heap
+    void HeapInsert(PendingInterrupt *toOccur);	// Add to the heap
+    PendingInterrupt *HeapRemove();	// Take off the earliest interrupt
 
     void ChangeLevel(IntStatus old, 	// SetLevel, without advancing the
 	IntStatus now);  		// simulated time
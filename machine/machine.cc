@@ -11,6 +11,23 @@
 #include "machine.h"
 #include "system.h"
 
+// Size of user memory, set from the command line before the Machine
+// is created.
+int pageSize = DefaultPageSize;
+int numPhysPages = DefaultNumPhysPages;
+
+// Number of TLB entries.  Machines built with USE_TLB have a TLB by
+// default; "-tlb <size>" selects one (or removes it, with size 0).
+#ifdef USE_TLB
+int tlbSize = TLBSize;
+#else
+int tlbSize = 0;
+#endif
+
+// "-ipt" turns the TLB into an inverted page table, with one entry per
+// physical page frame.
+bool invertedTable = FALSE;
+
 // Textual names of the exceptions that can be generated by user program
 // execution, for debugging.
 static char* exceptionNames[] = { "no exception", "syscall", 
@@ -61,15 +78,31 @@ Machine::Machine(bool debug)
     mainMemory = new char[MemorySize];
     for (i = 0; i < MemorySize; i++)
       	mainMemory[i] = 0;
-#ifdef USE_TLB
-    tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++)
-	tlb[i].valid = FALSE;
-    pageTable = NULL;
-#else	// use linear page table
-    tlb = NULL;
+    if (tlbSize > 0) {
+	tlb = new TranslationEntry[tlbSize];
+	for (i = 0; i < tlbSize; i++) {
+	    tlb[i].valid = FALSE;
+	    tlb[i].pages = 1;
+	}
+    } else			// use linear page table
+	tlb = NULL;
+    hashAnchor = hashNext = NULL;
+    hashSize = 0;
+    if (invertedTable) {
+	ASSERT(tlbSize == NumPhysPages);
+	hashSize = 2 * NumPhysPages + 1;	// short chains
+	hashAnchor = new int[hashSize];
+	hashNext = new int[tlbSize];
+	for (i = 0; i < hashSize; i++)
+	    hashAnchor[i] = -1;
+	for (i = 0; i < tlbSize; i++)
+	    hashNext[i] = -1;
+	stats->iptBytes = tlbSize * (sizeof(TranslationEntry) + sizeof(int))
+			+ hashSize * sizeof(int);
+    }
     pageTable = NULL;
-#endif
+    pageDirectory = NULL;
+    asid = 0;
 
     singleStep = debug;
     CheckEndian();
@@ -85,6 +118,8 @@ Machine::~Machine()
     delete [] mainMemory;
     if (tlb != NULL)
         delete [] tlb;
+    delete [] hashAnchor;
+    delete [] hashNext;
 }
 
 //----------------------------------------------------------------------
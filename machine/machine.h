@@ -26,15 +26,36 @@
 #include "translate.h"
 #include "disk.h"
 
-// Definitions related to the size, and format of user memory
+// Definitions related to the size, and format of user memory.
+// The page size, the amount of physical memory and the size of the
+// TLB are chosen when Nachos boots (see -pgsz, -mem and -tlb in 
+// main.cc); the constants below are their defaults.
 
-#define PageSize 	SectorSize 	// set the page size equal to
+#define DefaultPageSize	SectorSize 	// set the page size equal to
 					// the disk sector size, for
 					// simplicity
 
-#define NumPhysPages    32
-#define MemorySize 	(NumPhysPages * PageSize)
+#define DefaultNumPhysPages 32
 #define TLBSize		4		// if there is a TLB, make it small
+#define PageTableSpan	32		// pages per second-level page table
+
+extern int pageSize;			// bytes per page; a multiple of 4,
+					// so words never straddle pages
+extern int numPhysPages;		// number of physical page frames
+extern int tlbSize;			// number of TLB entries; 0 means the
+					// machine has no TLB and uses the
+					// linear page table instead (see -tlb)
+extern bool invertedTable;		// the TLB is a hashed inverted page
+					// table, one entry per frame (see -ipt)
+
+// The inverted page table is searched by hashing the virtual page
+// number and address space id into "hashAnchor"; entries whose pages
+// hash to the same bucket are chained through "hashNext".
+#define IptHash(vpn, id, size)	((((unsigned) (vpn) << 6) ^ (id)) % (size))
+
+#define PageSize 	pageSize
+#define NumPhysPages    numPhysPages
+#define MemorySize 	(NumPhysPages * PageSize)
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -159,19 +180,32 @@ class Machine {
 				// code and data, while executing
     int registers[NumTotalRegs]; // CPU registers, for executing user programs
     int vpn;
+    int asid;			// address space id of the running program;
+				// only TLB entries tagged with it match
 
 
 // NOTE: the hardware translation of virtual addresses in the user program
 // to physical addresses (relative to the beginning of "mainMemory")
 // can be controlled by one of:
 //	a traditional linear page table
+//	a two-level page table: a directory of pointers to tables of
+//	  PageTableSpan entries each, NULL where none has been set up
 //  	a software-loaded translation lookaside buffer (tlb) -- a cache of 
 //	  mappings of virtual page #'s to physical page #'s
 //
-// If "tlb" is NULL, the linear page table is used
+// If "tlb" is NULL, the two-level page table is used if there is one,
+//	the linear page table otherwise
 // If "tlb" is non-NULL, the Nachos kernel is responsible for managing
 //	the contents of the TLB.  But the kernel can use any data structure
 //	it wants (eg, segmented paging) for handling TLB cache misses.
+//	Each TLB entry is tagged with an address space id, and only
+//	matches while "asid" holds the same value.
+//	A TLB entry can map a superpage: "pages" consecutive virtual
+//	pages, to as many consecutive page frames.
+// If "hashAnchor" is non-NULL as well, the TLB is an inverted page table,
+//	with an entry per physical page frame: instead of comparing every
+//	entry, the hardware follows the hash chain of the page.  The
+//	kernel keeps the chains, and only valid entries, on them.
 // 
 // For simplicity, both the page table pointer and the TLB pointer are
 // public.  However, while there can be multiple page tables (one per address
@@ -185,6 +219,14 @@ class Machine {
     TranslationEntry *pageTable;
     unsigned int pageTableSize;
 
+    TranslationEntry **pageDirectory;	// two-level page table
+    unsigned int pageDirectorySize;	// number of second-level tables
+
+    int *hashAnchor;			// inverted page table: first slot
+					// of each hash chain, or -1
+    int *hashNext;			// next slot on the chain of each one
+    int hashSize;			// number of hash chains
+
   private:
     bool singleStep;		// drop back into the debugger after each
 				// simulated instruction
@@ -14,6 +14,7 @@
 
 #include "machine.h"
 #include "mipssim.h"
+#include "opcodes.h"
 #include "system.h"
 
 static void Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr);
@@ -102,6 +103,8 @@ Machine::OneInstruction(Instruction *instr)
 	return;			// exception occurred
     instr->value = raw;
     instr->Decode();
+    int pc = registers[PCReg];
+    int addr = registers[instr->rs] + instr->extra;	// if load or store
 
     if (DebugIsEnabled('m')) {
        struct OpString *str = &opStrings[instr->opCode];
@@ -531,6 +534,8 @@ Machine::OneInstruction(Instruction *instr)
 	break;
     	
       case OP_SYSCALL:
+	if (profiler != NULL)
+	    profiler->Count(pc, instr->opCode, addr);
 	RaiseException(SyscallException, 0);
 	return; 
 	
@@ -552,6 +557,8 @@ Machine::OneInstruction(Instruction *instr)
     }
     
     // Now we have successfully executed the instruction.
+    if (profiler != NULL)
+	profiler->Count(pc, instr->opCode, addr);
     
     // Do any delayed load operation
     DelayedLoad(nextLoadReg, nextLoadValue);
@@ -689,3 +696,45 @@ Mult(int a, int b, bool signedArith, int* hiPtr, int* loPtr)
     *hiPtr = (int) hi;
     *loPtr = (int) lo;
 }
+
+//----------------------------------------------------------------------
+// NumOpcodes, OpcodeString, IsLoad, IsStore
+// 	Describe the opcodes of decoded instructions to code outside the
+//	simulator, such as the profiler (see opcodes.h).
+//----------------------------------------------------------------------
+
+int
+NumOpcodes()
+{
+    return MaxOpcode + 1;
+}
+
+char *
+OpcodeString(int opCode)
+{
+    ASSERT(opCode >= 0 && opCode <= MaxOpcode);
+    return opStrings[opCode].string;
+}
+
+bool
+IsLoad(int opCode)
+{
+    switch (opCode) {
+      case OP_LB: case OP_LBU: case OP_LH: case OP_LHU:
+      case OP_LW: case OP_LWL: case OP_LWR:
+	return TRUE;
+      default:
+	return FALSE;
+    }
+}
+
+bool
+IsStore(int opCode)
+{
+    switch (opCode) {
+      case OP_SB: case OP_SH: case OP_SW: case OP_SWL: case OP_SWR:
+	return TRUE;
+      default:
+	return FALSE;
+    }
+}
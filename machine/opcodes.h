@@ -0,0 +1,21 @@
+// opcodes.h
+//	What the rest of Nachos may need to know about the opcodes the
+//	simulated CPU decodes instructions into (the OP_ values of
+//	mipssim.h), without the decoding tables that come with them.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef OPCODES_H
+#define OPCODES_H
+
+#include "copyright.h"
+
+extern int NumOpcodes();		// opcodes go from 0 to this - 1
+extern char *OpcodeString(int opCode);	// how it is printed by "-d m":
+					// the mnemonic, then its operands
+extern bool IsLoad(int opCode);		// does it read memory,
+extern bool IsStore(int opCode);	// or write it?
+
+#endif // OPCODES_H
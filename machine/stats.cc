@@ -24,6 +24,41 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numTLBHits = numTLBMisses = numZeroFills = 0;
+    numClusterReads = numClusterWrites = 0;
+    numReclaims = numPageOuts = 0;
+    numPrefetched = numPrefetchHits = numReadFaults = 0;
+    numTrimmed = numSuspends = 0;
+    numSharedPages = numCopiesOnWrite = numSharedText = 0;
+    numSuperPages = numDemotions = 0;
+    numIptLookups = numIptProbes = iptBytes = 0;
+    pageTableBytes = linearTableBytes = 0;
+    maxPageTableBytes = maxLinearTableBytes = 0;
+    numSpawns = spawnTicks = maxSpawnTicks = 0;
+    numCheckpoints = checkpointPages = checkpointTicks = numRestores = 0;
+    numCleanEvictions = numDirtyEvictions = 0;
+    faultTicks = maxFaultTicks = 0;
+    for (int i = 0; i < FaultBuckets; i++)
+	faultHistogram[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// Statistics::CountFault
+// 	Add a page fault, that took "ticks" from the fault until the
+//	thread could go on, to the latency histogram.
+//----------------------------------------------------------------------
+
+void
+Statistics::CountFault(int ticks)
+{
+    int bucket = 0;
+
+    while (bucket < FaultBuckets - 1 && (ticks >> (bucket + 1)) > 0)
+	bucket++;
+    faultHistogram[bucket]++;
+    faultTicks += ticks;
+    if (ticks > maxFaultTicks)
+	maxFaultTicks = ticks;
 }
 
 //----------------------------------------------------------------------
@@ -45,7 +80,66 @@ Statistics::Print()
     printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
-    printf("Paging: faults %d\n", numPageFaults);
+    printf("Paging: faults %d, zero-filled %d\n", numPageFaults,
+	numZeroFills);
+    if (numCleanEvictions + numDirtyEvictions > 0)
+	printf("Evictions: %d clean, %d dirty\n", numCleanEvictions,
+	    numDirtyEvictions);
+    if (numPageFaults > 0) {
+	printf("Fault latency: %.1f ticks on average, %d at most\n",
+	    (double) faultTicks / numPageFaults, maxFaultTicks);
+	for (int i = 0; i < FaultBuckets; i++) {
+	    if (faultHistogram[i] == 0)
+		continue;
+	    if (i == FaultBuckets - 1)
+		printf("  %6d and more: %d\n", 1 << i, faultHistogram[i]);
+	    else
+		printf("  %6d to %6d: %d\n", (i == 0) ? 0 : 1 << i,
+		    (1 << (i + 1)) - 1, faultHistogram[i]);
+	}
+    }
+    if (numClusterReads + numClusterWrites > 0)
+	printf("Clustering: %d pages read ahead, %d pages written early\n",
+	    numClusterReads, numClusterWrites);
+    if (numReclaims + numPageOuts > 0)
+	printf("Pageout: %d dirty pages written by the daemon, %d pages "
+	    "reclaimed\n", numPageOuts, numReclaims);
+    if (numPrefetched > 0)
+	printf("Prefetch: %d pages read ahead, %d used (accuracy %.1f%%, "
+	    "coverage %.1f%%)\n", numPrefetched, numPrefetchHits,
+	    100.0 * numPrefetchHits / numPrefetched,
+	    100.0 * numPrefetchHits / (numPrefetchHits + numReadFaults));
+    if (numTrimmed + numSuspends > 0)
+	printf("Load control: %d unused pages trimmed, %d processes "
+	    "suspended\n", numTrimmed, numSuspends);
+    if (numSharedPages > 0)
+	printf("Copy on write: %d pages shared by Fork, %d copied\n",
+	    numSharedPages, numCopiesOnWrite);
+    if (numSharedText > 0)
+	printf("Shared text: %d code pages mapped from another process\n",
+	    numSharedText);
+    if (numSuperPages > 0)
+	printf("Superpages: %d brought in, %d demoted\n", numSuperPages,
+	    numDemotions);
+    if (numTLBHits + numTLBMisses > 0)
+	printf("TLB: hits %d, misses %d, hit rate %.2f%%\n", numTLBHits,
+	    numTLBMisses, 100.0 * numTLBHits / (numTLBHits + numTLBMisses));
+    if (iptBytes > 0) {
+	printf("Inverted page table: %d bytes, %d lookups, %.2f entries "
+	    "probed per lookup\n", iptBytes, numIptLookups,
+	    numIptLookups > 0 ? (double) numIptProbes / numIptLookups : 0.0);
+	printf("Page tables: peak %d bytes two-level, %d bytes linear\n",
+	    maxPageTableBytes, maxLinearTableBytes);
+    }
+    if (numSpawns > 0)
+	printf("Exec: %d processes started, %.1f ticks to the first "
+	    "instruction on average, %d at most\n", numSpawns,
+	    (double) spawnTicks / numSpawns, maxSpawnTicks);
+    if (numCheckpoints + numRestores > 0)
+	printf("Checkpoints: %d taken, %d pages saved, %.1f ticks each on "
+	    "average; %d restored\n", numCheckpoints, checkpointPages,
+	    numCheckpoints > 0 ? (double) checkpointTicks / numCheckpoints
+			       : 0.0, numRestores);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
 }
@@ -13,6 +13,11 @@
 
 #include "copyright.h"
 
+#define FaultBuckets	16	// page fault latency histogram: bucket 0
+				// counts faults of 0 or 1 tick, bucket i
+				// those of 2^i to 2^(i+1)-1 ticks, and
+				// the last one everything longer
+
 // The following class defines the statistics that are to be kept
 // about Nachos behavior -- how much time (ticks) elapsed, how
 // many user instructions executed, etc.
@@ -33,11 +38,52 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numZeroFills;		// page faults served without a disk read
+    int numClusterReads;	// pages read along with a faulting page
+    int numClusterWrites;	// dirty pages written along with a victim
+    int numReclaims;		// faults on pages still in a free frame
+    int numCleanEvictions;	// pages evicted without being written
+    int numDirtyEvictions;	// pages written back when evicted
+    int faultTicks;		// total ticks from page faults until the
+				// faulting threads could resume
+    int maxFaultTicks;		// longest of them
+    int faultHistogram[FaultBuckets];	// how long the faults took
+    int numPageOuts;		// dirty pages written by the pageout daemon
+    int numPrefetched;		// pages read ahead along a stride
+    int numPrefetchHits;	// faults served by a page read ahead
+    int numReadFaults;		// faults that had to read their page
+    int numTrimmed;		// unused pages taken away by the PFF allocator
+    int numSuspends;		// processes swapped out for lack of memory
+    int numSharedPages;		// pages shared by Fork instead of copied
+    int numCopiesOnWrite;	// shared pages copied when written
+    int numSharedText;		// code page faults served from another
+				// process running the same program
+    int numSuperPages;		// superpages brought in at once
+    int numDemotions;		// superpages broken up by an eviction
+    int numTLBHits;		// number of translations found in the TLB
+    int numTLBMisses;		// number of TLB misses refilled by the kernel
+    int numIptLookups;		// translations looked up by hashing
+    int numIptProbes;		// inverted page table entries compared
+    int iptBytes;		// size of the inverted page table
+    int pageTableBytes;		// translation entries and directories
+				// of the two-level page tables
+    int linearTableBytes;	// what linear page tables would take
+    int maxPageTableBytes;	// peaks of the last two
+    int maxLinearTableBytes;
+    int numSpawns;		// processes started by Exec
+    int spawnTicks;		// total ticks from Exec to their first
+				// instruction
+    int maxSpawnTicks;		// and the longest of them
+    int numCheckpoints;		// processes saved by Checkpoint
+    int checkpointPages;	// pages they saved
+    int checkpointTicks;	// total ticks spent saving them
+    int numRestores;		// processes resumed from a checkpoint
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
     Statistics(); 		// initialize everything to zero
 
+    void CountFault(int ticks);	// a page fault was served in "ticks"
     void Print();		// print collected statistics
 };
 
@@ -190,7 +190,7 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     unsigned int vpn, offset;
     TranslationEntry *entry;
     unsigned int pageFrame;
-    int* eliminar,*Caldo = new int;
+    unsigned int superOffset = 0;	// page within a superpage
     
     DEBUG('a', "\tTranslate 0x%x, %s: ", virtAddr, writing ? "write" : "read");
 
@@ -201,8 +201,8 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     }
     
     // we must have either a TLB or a page table, but not both!
-    ASSERT(tlb == NULL || pageTable == NULL);	
-    ASSERT(tlb != NULL || pageTable != NULL);	
+    ASSERT(tlb == NULL || (pageTable == NULL && pageDirectory == NULL));
+    ASSERT(tlb != NULL || pageTable != NULL || pageDirectory != NULL);
 
 // calculate the virtual page number, and offset within the page,
 // from the virtual address
@@ -210,7 +210,19 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
     offset = (unsigned) virtAddr % PageSize;
     DEBUG('a',"VA: %d, VPN: %d of: %d\n",virtAddr,vpn,offset);
     machine->vpn = vpn;
-    if (tlb == NULL) {		// => page table => vpn is index into table
+    if (tlb == NULL && pageDirectory != NULL) {	// => two-level page table
+	if (vpn >= pageDirectorySize * PageTableSpan) {
+	    DEBUG('a', "virtual page # %d too large for page directory "
+			"size %d!\n", vpn, pageDirectorySize);
+	    return AddressErrorException;
+	}
+	entry = pageDirectory[vpn / PageTableSpan];
+	if (entry == NULL || !entry[vpn % PageTableSpan].valid) {
+	    DEBUG('a', "virtual page # %d not valid!\n", vpn);
+	    return PageFaultException;
+	}
+	entry = &entry[vpn % PageTableSpan];
+    } else if (tlb == NULL) {	// => page table => vpn is index into table
 	if (vpn >= pageTableSize) {
 	    DEBUG('a', "virtual page # %d too large for page table size %d!\n", 
 			virtAddr, pageTableSize);
@@ -220,61 +232,63 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 			virtAddr, pageTableSize);            
 	    return PageFaultException;
 	}
-	else
-	{
-	    //printf("Entro al else\n");
-	    if(numAlgoritmo == 3)
-	    {
-		//lista->imprimeLista();
-	        //cambia la victima al inicio para que sea mas facil su proceso
-	        eliminar = (int*)(lista->insIniLRU(&vpn));
-		//printf("Eliminar:%d\n",*eliminar);
-		*Caldo = *eliminar;	        
-		lista->Append(Caldo);
-		//lista->imprimeLista();
-		//printf("Ya imprimio dos veces\n");
-	    }
-	}
 	entry = &pageTable[vpn];
     } 
+    else if (hashAnchor != NULL) {	// => inverted page table
+	stats->numIptLookups++;
+	for (i = hashAnchor[IptHash(vpn, asid, hashSize)]; i != -1;
+			i = hashNext[i]) {
+	    stats->numIptProbes++;
+	    if (tlb[i].virtualPage == vpn && tlb[i].asid == asid)
+		break;
+	}
+	if (i == -1) {
+	    DEBUG('a', "*** virtual page # %d not in the inverted page "
+			"table!\n", vpn);
+	    stats->numTLBMisses++;
+	    return PageFaultException;
+	}
+	entry = &tlb[i];
+	stats->numTLBHits++;
+    }
     else 
     {
-        for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == vpn)) {
+        for (entry = NULL, i = 0; i < tlbSize; i++)
+    	    if (tlb[i].valid && (vpn - tlb[i].virtualPage < 
+			(unsigned) tlb[i].pages) && (tlb[i].asid == asid)) {
 		entry = &tlb[i];			// FOUND!
-		break;
+		superOffset = vpn - tlb[i].virtualPage;	// 0 unless it is
+		break;					// a superpage
 	    }
 	if (entry == NULL) {				// not found
     	    DEBUG('a', "*** no valid TLB entry found for this virtual page!\n");
+	    stats->numTLBMisses++;
     	    return PageFaultException;		// really, this is a TLB fault,
 						// the page may be in memory,
 						// but not in the TLB
 	}
+	stats->numTLBHits++;
     }
 
-    //lista->Append((void*)&machine->pageTable[vpn].virtualPage);
-/*    printf("Cadena de Referencia");
-    for (ListElement *ptr = lista->first; ptr != NULL; ptr = ptr->next)    
-    {
-        printf("%d ", *(int*)ptr->item);
-    }
-    printf("\n");*/
-
     if (entry->readOnly && writing) {	// trying to write to a read-only page
 	DEBUG('a', "%d mapped read-only at %d in TLB!\n", virtAddr, i);
 	return ReadOnlyException;
     }
-    pageFrame = entry->physicalPage;
+    pageFrame = entry->physicalPage + superOffset;
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
-    if (pageFrame >= NumPhysPages) { 
+    if (pageFrame >= (unsigned) NumPhysPages) { 
 	DEBUG('a', "*** frame %d > %d!\n", pageFrame, NumPhysPages);
 	return BusErrorException;
     }
     entry->use = TRUE;		// set the use, dirty bits
     if (writing)
 	entry->dirty = TRUE;
+    if (pagePolicy != NULL)	// the kernel's LRU and LFU policies need
+	pagePolicy->Referenced(pageFrame, writing);	// every reference
+    if (refTrace != NULL)
+	refTrace->Record(currentThread->space->GetPid(), vpn, writing);
     *physAddr = pageFrame * PageSize + offset;
     ASSERT((*physAddr >= 0) && ((*physAddr + size) <= MemorySize));
     DEBUG('a', "phys addr = 0x%x\n", *physAddr);
@@ -40,6 +40,12 @@ class TranslationEntry {
 			// page is referenced or modified.
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
+    int asid;		// TLB only: address space id the entry belongs
+			// to.  Ignored in page tables.
+    int pages;		// TLB only: number of pages mapped, from
+			// virtualPage on, to frames from physicalPage on;
+			// more than 1 for a superpage.  Ignored in page
+			// tables.
 };
 
 #endif
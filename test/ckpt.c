@@ -0,0 +1,44 @@
+/* ckpt.c 
+ *    Test of Checkpoint: fill an array, a page of heap and the stack,
+ *    save the process to the file "ckpt.img" halfway through summing
+ *    them up, and finish.  Resuming it from there must give the same
+ *    sum, without filling anything again:
+ *
+ *	nachos -d a -x ckpt		exits with the sum
+ *	nachos -d a -restore ckpt.img	exits with the sum + 1048576
+ *
+ *    Run the first one with little memory (-mem 8, say) to have some
+ *    of the pages saved from swap.
+ */
+
+#include "syscall.h"
+
+#define Size	1024
+
+int A[Size];
+
+int
+main()
+{
+    int local[Size / 4];
+    int *heap = (int *) Sbrk(Size);
+    int i, sum = 0, resumed;
+
+    for (i = 0; i < Size; i++)		/* fill everything */
+	A[i] = 7 * i + 3;
+    for (i = 0; i < Size / 4; i++)
+	local[i] = heap[i] = i;
+
+    for (i = 0; i < Size / 2; i++)	/* sum half of it */
+	sum += A[i];
+
+    resumed = Checkpoint("ckpt.img");
+    if (resumed == -1)
+	Exit(-1);
+
+    for (; i < Size; i++)		/* and the rest */
+	sum += A[i];
+    for (i = 0; i < Size / 4; i++)
+	sum += local[i] + heap[i];
+    Exit(sum + (resumed << 20));
+}
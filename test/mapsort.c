@@ -0,0 +1,48 @@
+/* mapsort.c 
+ *    Test program for Map: sort, like sort.c, but an array kept in a
+ *    Nachos file, mapped into the address space, rather than one in
+ *    the program's own memory.  The pages of the file are faulted in
+ *    from it, and written back to it, by the kernel; the program does
+ *    no I/O of its own besides creating the file in the first place.
+ *
+ *    Exits with status 0 if the sorted array made it back to the file.
+ */
+
+#include "syscall.h"
+
+#define N	1024
+
+int A[N];
+
+int
+main()
+{
+    OpenFileId f;
+    int *B, i, j, tmp, first;
+
+    /* write the array, in reverse sorted order, to a file */
+    for (i = 0; i < N; i++)
+        A[i] = N - i;
+    Create("sortdata");
+    f = Open("sortdata");
+    Write((char *) A, sizeof(A), f);
+    Close(f);
+
+    /* then sort it in place, in the file! */
+    B = (int *) Map("sortdata");
+    if (B == 0)
+	Exit(2);
+    for (i = 0; i < N - 1; i++)
+        for (j = i; j < (N - 1 - i); j++)
+	   if (B[j] > B[j + 1]) {	/* out of order -> need to swap ! */
+	      tmp = B[j];
+	      B[j] = B[j + 1];
+	      B[j + 1] = tmp;
+    	   }
+    Unmap((char *) B);
+
+    f = Open("sortdata");
+    Read((char *) &first, sizeof(int), f);
+    Close(f);
+    Exit(first != 1);
+}
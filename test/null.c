@@ -0,0 +1,12 @@
+/* null.c 
+ *    The smallest program that runs to completion: it just exits.
+ *    Started many times over by spawn.c.
+ */
+
+#include "syscall.h"
+
+int
+main()
+{
+    Exit(0);
+}
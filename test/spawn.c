@@ -0,0 +1,39 @@
+/* spawn.c 
+ *    Benchmark of process creation: Exec the trivial program "null"
+ *    over and over, first one at a time (each one joined before the
+ *    next is started), then in batches running side by side.  The
+ *    kernel reports how many ticks each process took from Exec to
+ *    its first instruction, when Nachos halts.
+ *
+ *    Exits with the number of children that did not exit with
+ *    status 0, plus one if Exec accepts a file that is not a program.
+ */
+
+#include "syscall.h"
+
+#define Rounds	20	/* processes started one at a time */
+#define Batch	4	/* and this many at once, */
+#define Batches	5	/* this many times */
+
+int
+main()
+{
+    SpaceId kids[Batch];
+    int i, j, failed = 0;
+
+    for (i = 0; i < Rounds; i++)
+	if (Join(Exec("../test/null")) != 0)
+	    failed++;
+
+    for (i = 0; i < Batches; i++) {
+	for (j = 0; j < Batch; j++)
+	    kids[j] = Exec("../test/null");
+	for (j = 0; j < Batch; j++)
+	    if (Join(kids[j]) != 0)
+		failed++;
+    }
+
+    if (Exec("../test/spawn.c") != -1)	/* the source, not NOFF */
+	failed++;
+    Exit(failed);
+}
@@ -130,6 +130,38 @@ Yield:
 	j	$31
 	.end Yield
 
+	.globl Map
+	.ent	Map
+Map:
+	addiu $2,$0,SC_Map
+	syscall
+	j	$31
+	.end Map
+
+	.globl Unmap
+	.ent	Unmap
+Unmap:
+	addiu $2,$0,SC_Unmap
+	syscall
+	j	$31
+	.end Unmap
+
+	.globl Sbrk
+	.ent	Sbrk
+Sbrk:
+	addiu $2,$0,SC_Sbrk
+	syscall
+	j	$31
+	.end Sbrk
+
+	.globl Checkpoint
+	.ent	Checkpoint
+Checkpoint:
+	addiu $2,$0,SC_Checkpoint
+	syscall
+	j	$31
+	.end Checkpoint
+
 /* dummy function to keep gcc happy */
         .globl  __main
         .ent    __main
@@ -0,0 +1,39 @@
+/* thrash.c 
+ *    Thrashing benchmark: matmult, but exiting instead of halting, so
+ *    that several copies can run side by side until they are all done.
+ *
+ *    Each copy needs about 40 pages; run more of them than fit in
+ *    physical memory, with and without page fault frequency load
+ *    control, and compare the total ticks and page faults:
+ *
+ *	nachos -rs 1 -xm thrash thrash thrash thrash
+ *	nachos -rs 1 -pff 10000 -xm thrash thrash thrash thrash
+ */
+
+#include "syscall.h"
+
+#define Dim 	20
+
+int A[Dim][Dim];
+int B[Dim][Dim];
+int C[Dim][Dim];
+
+int
+main()
+{
+    int i, j, k;
+
+    for (i = 0; i < Dim; i++)		/* first initialize the matrices */
+	for (j = 0; j < Dim; j++) {
+	     A[i][j] = i;
+	     B[i][j] = j;
+	     C[i][j] = 0;
+	}
+
+    for (i = 0; i < Dim; i++)		/* then multiply them together */
+	for (j = 0; j < Dim; j++)
+            for (k = 0; k < Dim; k++)
+		 C[i][j] += A[i][k] * B[k][j];
+
+    Exit(C[Dim-1][Dim-1]);		/* and then we're done */
+}
@@ -8,8 +8,16 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
-//		-s -x <nachos file> -c <consoleIn> <consoleOut>
+// Usage: nachos -d <debugflags> -rs <random seed #> -stats
+//		-s -x <nachos file> -xm <nachos file> ...
+//		-restore <nachos file>
+//		-c <consoleIn> <consoleOut>
+//		-tlb <entries> -tlbp <fifo|random|clock> -tlbflush -ipt
+//		-mem <frames> -pgsz <bytes> -prof
+//		-pol <fifo|clock|lru|eclock|aging|lfu> -rtrace <unix file>
+//		-cluster <pages> -pageout <frames> -swap <pages>
+//		-pff <ticks> -prefetch <pages> -super <pages>
+//		-faults <unix file>
 //		-f -cp <unix file> <nachos file>
 //		-p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -m <machine id>
@@ -18,12 +26,54 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -stats prints the performance statistics when Nachos halts
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
 //    -x runs a user program
+//    -xm runs the given user programs concurrently, paging in the
+//	same physical memory (use it with -rs)
+//    -restore resumes a user program from the checkpoint it saved in
+//	the given file with the Checkpoint system call
 //    -c tests the console
+//    -tlb runs user programs on a TLB with the given number of entries
+//	(0 means use the linear page table)
+//    -tlbp selects which TLB entry is replaced on a miss
+//    -tlbflush flushes the TLB on context switches, instead of tagging
+//	the entries with address space ids
+//    -ipt replaces the TLB by a hashed inverted page table, with an
+//	entry per physical page frame, and compares its footprint with
+//	that of the page tables
+//    -mem sets the number of physical page frames (default 32)
+//    -pgsz sets the page size in bytes, a multiple of 4 (default: the
+//	disk sector size)
+//    -prof counts the instructions executed by user programs, and
+//	prints a profile when they halt
+//    -pol selects the page replacement policy (default clock, see
+//	userprog/replace.h)
+//    -rtrace records the page reference string of user programs in a
+//	UNIX file, for vm/refsim
+//    -cluster sets how many neighbouring pages a page fault may read
+//	from swap, or write back to it, in one disk request (default 1)
+//    -pageout starts a pageout daemon thread, which keeps the given
+//	number of frames free (it gets to run when the user program is
+//	preempted, so use it with -rs)
+//    -pff allocates frames by page fault frequency: a process that
+//	goes more than the given number of its own ticks without a fault
+//	loses its unused pages, and processes are suspended when memory
+//	is overcommitted (see userprog/coremap.h)
+//    -swap sets the size of the swap area, in pages (default 8 per
+//	physical page frame)
+//    -prefetch starts a prefetch daemon thread, which reads up to the
+//	given number of pages ahead when the page faults of a program
+//	follow a stride (it also needs -rs to get to run)
+//    -super brings the program into memory by superpages of the given
+//	number of pages (8 or 16, say; it must divide 32), each mapped
+//	by a single TLB entry, when there is room for them
+//    -faults records every page fault as a line of CSV in a UNIX file,
+//	and prints fault counters per process when Nachos halts (see
+//	userprog/faultlog.h)
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
@@ -59,6 +109,8 @@
 extern void ThreadTest(void), Copy(char *unixFile, char *nachosFile);
 extern void Print(char *file), PerformanceTest(void);
 extern void StartProcess(char *file), ConsoleTest(char *in, char *out);
+extern void StartProcesses(char **files, int count);
+extern void RestoreProcess(char *fileName);
 extern void MailTest(int networkID);
 
 //----------------------------------------------------------------------
@@ -94,6 +146,15 @@ main(int argc, char **argv)
 	    ASSERT(argc > 1);
             StartProcess(*(argv + 1));
             argCount = 2;
+        } else if (!strcmp(*argv, "-xm")) {	// run several at once
+	    while (argCount < argc && **(argv + argCount) != '-')
+		argCount++;
+	    ASSERT(argCount > 1);
+	    StartProcesses(argv + 1, argCount - 1);
+        } else if (!strcmp(*argv, "-restore")) {	// resume one
+	    ASSERT(argc > 1);
+	    RestoreProcess(*(argv + 1));
+	    argCount = 2;
         } else if (!strcmp(*argv, "-c")) {      // test the console
 	    if (argc == 1)
 	        ConsoleTest(NULL, NULL);
@@ -18,6 +18,7 @@ Interrupt *interrupt;			// interrupt status
 Statistics *stats;			// performance metrics
 Timer *timer;				// the hardware timer device,
 					// for invoking context switches
+bool printStats = FALSE;		// print them when halting?
 
 #ifdef FILESYS_NEEDED
 FileSystem  *fileSystem;
@@ -29,10 +30,19 @@ SynchDisk   *synchDisk;
 
 #ifdef USER_PROGRAM	// requires either FILESYS or FILESYS_STUB
 Machine *machine;	// user program memory and registers
-OpenFile *archivo;
-unsigned int numAlgoritmo;
-int marcosVictima[NumPhysPages];
-List *lista;
+TLBManager *tlbManager;	// TLB refill and replacement, NULL
+			// when using the linear page table
+Profiler *profiler;	// instruction counts, NULL unless profiling
+ReplacementPolicy *pagePolicy;	// chooses the page to evict
+RefTrace *refTrace;	// page reference string, NULL unless recording
+FaultLog *faultLog;	// page fault records, NULL unless recording
+int clusterSize = 1;	// pages per swap read or write
+int superPageSize = 0;	// pages brought in and mapped together
+CoreMap *coreMap;	// who is in each physical page frame
+SwapMap *swapMap;	// who is in each swap slot
+TextCache *textCache;	// programs being run, to share their code
+SynchConsole *synchConsole;	// NULL until a program uses the console
+ProcessTable *processTable;	// user processes, by SpaceId
 #endif
 
 #ifdef NETWORK
@@ -68,6 +78,41 @@ TimerInterruptHandler(int dummy)
 	interrupt->YieldOnReturn();
 }
 
+#ifdef USER_PROGRAM
+//----------------------------------------------------------------------
+// PageOutDaemon
+// 	Body of the pageout daemon thread; see CoreMap::PageOut.
+//----------------------------------------------------------------------
+static void
+PageOutDaemon(int dummy)
+{
+    coreMap->PageOut();
+}
+
+//----------------------------------------------------------------------
+// PrefetchDaemon
+// 	Body of the prefetch daemon thread; see CoreMap::Prefetch.
+//----------------------------------------------------------------------
+
+static void
+PrefetchDaemon(int dummy)
+{
+    coreMap->Prefetch();
+}
+
+//----------------------------------------------------------------------
+// SyncTLBBits
+// 	Copy the use bits the TLB has collected into the page tables,
+//	for a replacement policy that reads them between faults.
+//----------------------------------------------------------------------
+
+static void
+SyncTLBBits()
+{
+    tlbManager->SyncBits();
+}
+#endif
+
 //----------------------------------------------------------------------
 // Initialize
 // 	Initialize Nachos global data structures.  Interpret command
@@ -87,6 +132,16 @@ Initialize(int argc, char **argv)
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    TLBPolicy tlbPolicy = TLBFifo;	// TLB slot replacement
+    bool tlbTagged = TRUE;	// tag TLB entries with address space ids
+    bool profiling = FALSE;	// count user instructions
+    char *policyName = "clock";	// page replacement policy
+    char *traceName = NULL;	// where to record page references
+    char *faultLogName = NULL;	// where to record page faults
+    int freeTarget = 0;		// free frames for the pageout daemon
+    int pffInterval = 0;	// page fault frequency threshold
+    int prefetchDepth = 0;	// pages to read ahead along a stride
+    int swapSlots = 0;		// size of the swap area, 0 for the default
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
@@ -111,10 +166,86 @@ Initialize(int argc, char **argv)
 						// number generator
 	    randomYield = TRUE;
 	    argCount = 2;
-	}
+	} else if (!strcmp(*argv, "-stats"))
+	    printStats = TRUE;
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+	else if (!strcmp(*argv, "-tlb")) {
+	    ASSERT(argc > 1);
+	    tlbSize = atoi(*(argv + 1));
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-tlbp")) {
+	    ASSERT(argc > 1);
+	    if (!strcmp(*(argv + 1), "fifo"))
+		tlbPolicy = TLBFifo;
+	    else if (!strcmp(*(argv + 1), "random"))
+		tlbPolicy = TLBRandom;
+	    else if (!strcmp(*(argv + 1), "clock"))
+		tlbPolicy = TLBClock;
+	    else {
+		printf("Unknown TLB policy %s\n", *(argv + 1));
+		ASSERT(FALSE);
+	    }
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-tlbflush"))
+	    tlbTagged = FALSE;
+	else if (!strcmp(*argv, "-ipt"))
+	    invertedTable = TRUE;
+	else if (!strcmp(*argv, "-mem")) {
+	    ASSERT(argc > 1);
+	    numPhysPages = atoi(*(argv + 1));
+	    ASSERT(numPhysPages > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-pgsz")) {
+	    ASSERT(argc > 1);
+	    pageSize = atoi(*(argv + 1));
+	    ASSERT(pageSize > 0 && (pageSize % 4) == 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-prof"))
+	    profiling = TRUE;
+	else if (!strcmp(*argv, "-pol")) {
+	    ASSERT(argc > 1);
+	    policyName = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-cluster")) {
+	    ASSERT(argc > 1);
+	    clusterSize = atoi(*(argv + 1));
+	    ASSERT(clusterSize > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-pageout")) {
+	    ASSERT(argc > 1);
+	    freeTarget = atoi(*(argv + 1));
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-pff")) {
+	    ASSERT(argc > 1);
+	    pffInterval = atoi(*(argv + 1));
+	    ASSERT(pffInterval > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-swap")) {
+	    ASSERT(argc > 1);
+	    swapSlots = atoi(*(argv + 1));
+	    ASSERT(swapSlots > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-rtrace")) {
+	    ASSERT(argc > 1);
+	    traceName = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-super")) {
+	    ASSERT(argc > 1);
+	    superPageSize = atoi(*(argv + 1));
+	    ASSERT(superPageSize > 1 && PageTableSpan % superPageSize == 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-prefetch")) {
+	    ASSERT(argc > 1);
+	    prefetchDepth = atoi(*(argv + 1));
+	    ASSERT(prefetchDepth >= 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-faults")) {
+	    ASSERT(argc > 1);
+	    faultLogName = *(argv + 1);
+	    argCount = 2;
+	}
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -154,8 +285,31 @@ Initialize(int argc, char **argv)
     CallOnUserAbort(Cleanup);			// if user hits ctl-C
     
 #ifdef USER_PROGRAM
+    if (invertedTable)
+	tlbSize = NumPhysPages;		// an entry per frame
     machine = new Machine(debugUserProg);	// this must come first
-    archivo = NULL;
+    tlbManager = NULL;
+    if (machine->tlb != NULL)
+	tlbManager = new TLBManager(tlbPolicy, tlbTagged);
+    profiler = profiling ? new Profiler() : NULL;
+    pagePolicy = NewReplacementPolicy(policyName, NumPhysPages);
+    if (pagePolicy == NULL) {
+	printf("Unknown page replacement policy %s\n", policyName);
+	ASSERT(FALSE);
+    }
+    if (tlbManager != NULL)
+	pagePolicy->SetSync(SyncTLBBits);
+    refTrace = (traceName != NULL) ? new RefTrace(traceName, PageSize) : NULL;
+    faultLog = (faultLogName != NULL) ? new FaultLog(faultLogName) : NULL;
+    coreMap = new CoreMap(NumPhysPages, freeTarget, pffInterval,
+			prefetchDepth);
+    textCache = new TextCache();
+    synchConsole = NULL;
+    processTable = new ProcessTable();
+    if (freeTarget > 0)
+	(new Thread("pageout"))->Fork(PageOutDaemon, 0);
+    if (prefetchDepth > 0)
+	(new Thread("prefetch"))->Fork(PrefetchDaemon, 0);
 #endif
 
 #ifdef FILESYS
@@ -166,6 +320,12 @@ Initialize(int argc, char **argv)
     fileSystem = new FileSystem(format);
 #endif
 
+#ifdef USER_PROGRAM
+    // the swap area is a file, so it waits for the file system
+    swapMap = new SwapMap((swapSlots > 0) ? swapSlots
+					  : SwapPerFrame * NumPhysPages);
+#endif
+
 #ifdef NETWORK
     postOffice = new PostOffice(netname, rely, 10);
 #endif
@@ -184,6 +344,18 @@ Cleanup()
 #endif
     
 #ifdef USER_PROGRAM
+    if (profiler != NULL)		// however the programs ended
+	profiler->Print();
+    delete profiler;
+    delete pagePolicy;
+    delete refTrace;
+    delete faultLog;
+    delete coreMap;
+    delete swapMap;
+    delete textCache;
+    delete synchConsole;
+    delete processTable;
+    delete tlbManager;
     delete machine;
 #endif
 
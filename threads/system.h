@@ -30,14 +30,33 @@ extern Scheduler *scheduler;			// the ready list
 extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
+extern bool printStats;				// "-stats"
 
 #ifdef USER_PROGRAM
 #include "machine.h"
+#include "tlbmanager.h"
+#include "profiler.h"
+#include "replace.h"
+#include "reftrace.h"
+#include "faultlog.h"
+#include "coremap.h"
+#include "swapmap.h"
+#include "textcache.h"
+#include "synchconsole.h"
+#include "proctable.h"
 extern Machine* machine;	// user program memory and registers
-extern OpenFile *archivo;
-extern unsigned int numAlgoritmo;
-extern int marcosVictima[NumPhysPages];
-extern List *lista;
+extern TLBManager *tlbManager;	// kernel side of the TLB, if there is one
+extern Profiler *profiler;	// user instruction profile, if "-prof"
+extern ReplacementPolicy *pagePolicy;	// page replacement policy
+extern RefTrace *refTrace;	// page reference string, if "-rtrace"
+extern FaultLog *faultLog;	// every page fault, if "-faults"
+extern int clusterSize;		// pages moved per swap disk request
+extern int superPageSize;	// pages per superpage, 0 for none
+extern CoreMap *coreMap;	// physical page frames
+extern SwapMap *swapMap;	// slots in the swap area
+extern TextCache *textCache;	// code shared among processes
+extern SynchConsole *synchConsole;	// console of the system calls
+extern ProcessTable *processTable;	// SpaceIds, for Exec and Join
 #endif
 
 
@@ -18,7 +18,7 @@
 #include "copyright.h"
 #include "system.h"
 #include "addrspace.h"
-#include "noff.h"
+#include "syscall.h"
 
 //----------------------------------------------------------------------
 // SwapHeader
@@ -42,6 +42,46 @@ SwapHeader (NoffHeader *noffH)
 	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
 }
 
+//----------------------------------------------------------------------
+// SegmentFits
+// 	Return TRUE if segment "seg" of a program lies below "limit".
+//----------------------------------------------------------------------
+
+static bool
+SegmentFits(Segment *seg, int limit)
+{
+    return seg->size == 0 || (seg->size > 0 && seg->virtualAddr >= 0
+				&& seg->virtualAddr <= limit - seg->size);
+}
+
+//----------------------------------------------------------------------
+// IsExecutable
+// 	Return TRUE if "executable" is a NOFF program that fits below the
+//	stack of a demand paged address space, so that one can be made
+//	for it; the constructor below gives up on anything else.
+//----------------------------------------------------------------------
+
+bool
+IsExecutable(OpenFile *executable)
+{
+    NoffHeader noffH;
+    int limit = (divRoundUp(UserSpaceSize, PageSize) - MapRegionPages
+			- divRoundUp(UserStackMax, PageSize)) * PageSize;
+
+    if (executable->ReadAt((char *)&noffH, sizeof(noffH), 0)
+						!= sizeof(noffH))
+	return FALSE;
+    if ((noffH.noffMagic != NOFFMAGIC) && 
+		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
+    	SwapHeader(&noffH);
+    return noffH.noffMagic == NOFFMAGIC
+	&& SegmentFits(&noffH.code, limit)
+	&& SegmentFits(&noffH.initData, limit)
+	&& SegmentFits(&noffH.uninitData, limit)
+	&& noffH.code.size <= limit - noffH.initData.size
+			- noffH.uninitData.size;
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
@@ -61,6 +101,7 @@ AddrSpace::AddrSpace(OpenFile *executable)
 {
     NoffHeader noffH;
     unsigned int i, size;
+    TranslationEntry *entry;
 
     executable->ReadAt((char *)&noffH, sizeof(noffH), 0);
     if ((noffH.noffMagic != NOFFMAGIC) && 
@@ -76,7 +117,7 @@ AddrSpace::AddrSpace(OpenFile *executable)
     size = numPages * PageSize;
     
     //printf("%d <= %d", numPages,NumPhysPages);
-    ASSERT(numPages <= NumPhysPages);		// check we're not trying
+    ASSERT((int) numPages <= NumPhysPages);	// check we're not trying
 						// to run anything too big --
 						// at least until we have
 						// virtual memory
@@ -84,17 +125,36 @@ AddrSpace::AddrSpace(OpenFile *executable)
     DEBUG('a', "Initializing address space, num pages %d, size %d\n", 
 					numPages, size);
 // first, set up the translation 
-    pageTable = new TranslationEntry[numPages];
+    pageTable = new PageTable(numPages);
     for (i = 0; i < numPages; i++) {
-	pageTable[i].virtualPage = i;	// for now, virtual page # = phys page #
-	pageTable[i].physicalPage = i;
-	pageTable[i].valid = TRUE;
-	pageTable[i].use = FALSE;
-	pageTable[i].dirty = FALSE;
-	pageTable[i].readOnly = FALSE;  // if the code segment was entirely on 
-					// a separate page, we could set its 
-					// pages to be read-only
+	entry = pageTable->Entry(i);
+	entry->physicalPage = i;	// for now, virtual page # = phys page #
+	entry->valid = TRUE;
     }
+    asid = (tlbManager != NULL) ? tlbManager->AllocASID() : 0;
+    pid = -1;
+    faultCounts = NULL;
+    userTime = 0;
+    resumedAt = stats->userTicks;
+    numResident = lastFault = wanted = 0;
+    lastFaultPage = -1;
+    faultStride = strideRun = 0;
+    suspended = growing = FALSE;
+    resume = new Semaphore("resume", 0);
+    openFiles = new OpenFile*[MaxOpenFiles];
+    for (int f = 0; f < MaxOpenFiles; f++)
+	openFiles[f] = NULL;
+    exeFile = NULL;			// everything is in memory
+    mapBase = numPages;			// and nothing can be mapped
+    mapped = NULL;
+    heapStart = brk = size;		// or grow
+    stackLimit = numPages;
+    swapBase = -1;
+    swapPages = 0;
+    exeName = NULL;
+    text = NULL;
+    readBuffer = writeBuffer = NULL;
+    readCount = 0;
     
 // zero out the entire address space, to zero the unitialized data segment 
 // and the stack segment
@@ -116,12 +176,38 @@ AddrSpace::AddrSpace(OpenFile *executable)
 
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::AddrSpace
+// 	Create a demand paged address space for the program in
+//	"executable".  No page starts out in memory.  Pages of code and
+//	initialized data are read straight from the executable the first
+//	time they are referenced, and again whenever they are brought
+//	back in unmodified; pages that hold nothing but code are
+//	read-only, and shared with every other address space running the
+//	same executable (see textcache.h).  Modified pages are written to
+//	the swap area, each in a slot allocated the first time it is
+//	written (see swapmap.h).
+//
+//	Pages outside the code and initialized data (the uninitialized
+//	data, the heap and the stack) are not read from anywhere: the
+//	first time they are referenced, they are just zero filled.
+//
+//	The address space is UserSpaceSize bytes, laid out as: the
+//	program, the heap (empty at first, see Sbrk), a gap, the stack,
+//	growing down from below the top MapRegionPages pages, which are
+//	left for the files the program maps with Map.  The page table
+//	only has room for the pages that get used (see pagetable.h).
+//
+//	"executable" is the file containing the object code; the address
+//		space keeps it open, and closes it when it goes away
+//	"filename" is its name
+//----------------------------------------------------------------------
+
 AddrSpace::AddrSpace(OpenFile *executable, char* filename)
 {
     NoffHeader noffH;
     unsigned int i, size;
-    char nombreArch[100];
-    
+
     executable->ReadAt((char *)&noffH, sizeof(noffH), 0);    
     if ((noffH.noffMagic != NOFFMAGIC) && 
 		(WordToHost(noffH.noffMagic) == NOFFMAGIC))
@@ -129,52 +215,857 @@ AddrSpace::AddrSpace(OpenFile *executable, char* filename)
     ASSERT(noffH.noffMagic == NOFFMAGIC);
 
 // how big is address space?
-    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size 
-			+ UserStackSize;	// we need to increase the size
-						// to leave room for the stack
-    numPages = divRoundUp(size, PageSize);
-    size = numPages * PageSize;
-    
-    sprintf(nombreArch,"%s.swp",filename);
-    MenuAlgoritmos();
-    lista = new List();
-    if(fileSystem->Create(nombreArch,(noffH.code.size + noffH.initData.size)))
-    {    
-        archivo = fileSystem->Open(nombreArch);
-	executable->ReadAt(&(machine->mainMemory[0]),
-			noffH.code.size,noffH.code.inFileAddr);
-        archivo->Write(&(machine->mainMemory[0]),
-        		noffH.code.size);
-	executable->ReadAt(&(machine->mainMemory[0]),
-			noffH.initData.size,noffH.initData.inFileAddr);
-        archivo->Write(&(machine->mainMemory[0]),
-        		noffH.initData.size);
+    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size;
+    numPages = divRoundUp(UserSpaceSize, PageSize);
+    mapBase = numPages - MapRegionPages;
+    stackLimit = mapBase - divRoundUp(UserStackMax, PageSize);
+    heapStart = brk = size;
+    if ((int) divRoundUp(size, PageSize) > stackLimit) {
+	printf("Program %s does not fit in %d bytes\n", filename,
+						UserSpaceSize);
+	ASSERT(FALSE);
     }
 
-    DEBUG('a', "Initializing address space, num pages %d, size %d\n", 
-					numPages, size);
+    // the extent covers the program, and the top of the stack
+    swapPages = divRoundUp(size, PageSize)
+			+ divRoundUp(UserStackSize, PageSize);
+    swapBase = swapMap->ReserveExtent(swapPages);
+    exeFile = executable;
+    exeName = new char[strlen(filename) + 1];
+    strcpy(exeName, filename);
+    code = noffH.code;
+    initData = noffH.initData;
+    readBuffer = new char[clusterSize * PageSize];
+    writeBuffer = new char[clusterSize * PageSize];
+    readCount = 0;
+
+    DEBUG('a', "Initializing address space for %s, num pages %d, size %d\n", 
+					filename, numPages, size);
 // first, set up the translation 
-    pageTable = new TranslationEntry[numPages];
-    for (i = 0; i < numPages; i++) {
-	pageTable[i].virtualPage = i;	// for now, virtual page # = phys page #
-	pageTable[i].physicalPage = 0;
-	pageTable[i].valid = FALSE;
-	pageTable[i].use = FALSE;
-	pageTable[i].dirty = FALSE;
-	pageTable[i].readOnly = FALSE;  // if the code segment was entirely on 
-					// a separate page, we could set its 
-					// pages to be read-only
+    pageTable = new PageTable(numPages);
+    if (code.size > 0)
+	for (i = code.virtualAddr / PageSize;
+		i <= (unsigned) ((code.virtualAddr + code.size - 1) / PageSize);
+		i++) {
+	    pageTable->Info(i)->backing = InExecutable;
+	    // read-only if the page is all code: it starts and ends in the
+	    // code segment, and no initialized data sits in it
+	    pageTable->Entry(i)->readOnly =
+		(int) (i * PageSize) >= code.virtualAddr
+		&& (int) ((i + 1) * PageSize) <= code.virtualAddr + code.size
+		&& (initData.size == 0
+		    || (int) ((i + 1) * PageSize) <= initData.virtualAddr
+		    || (int) (i * PageSize)
+				>= initData.virtualAddr + initData.size);
+	}
+    if (initData.size > 0)
+	for (i = initData.virtualAddr / PageSize;
+		i <= (unsigned) ((initData.virtualAddr + initData.size - 1)
+							/ PageSize);
+		i++)
+	    pageTable->Info(i)->backing = InExecutable;
+    text = textCache->Attach(executable, filename,
+		divRoundUp(code.virtualAddr + code.size, PageSize));
+    mapped = new MappedFile*[MapRegionPages];
+    for (i = 0; i < MapRegionPages; i++)
+	mapped[i] = NULL;
+    asid = (tlbManager != NULL) ? tlbManager->AllocASID() : 0;
+    pid = -1;
+    faultCounts = NULL;
+    userTime = 0;
+    resumedAt = stats->userTicks;
+    numResident = lastFault = wanted = 0;
+    lastFaultPage = -1;
+    faultStride = strideRun = 0;
+    suspended = growing = FALSE;
+    resume = new Semaphore("resume", 0);
+    openFiles = new OpenFile*[MaxOpenFiles];
+    for (int f = 0; f < MaxOpenFiles; f++)
+	openFiles[f] = NULL;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AddrSpace
+// 	Create a child of address space "parent" (Fork), with the same
+//	contents, without copying any of them.  The pages the parent has
+//	in memory become copy-on-write: both spaces map the same frame
+//	read-only, until one of them writes to it (see
+//	CoreMap::CopyOnWrite).  The pages the parent has in swap stay
+//	where they are, in slots shared by both, until one of them
+//	writes the page out again.
+//
+//	Open files and mapped files are not inherited; the child only
+//	has the console.
+//
+//	"parent" is the address space of the thread calling Fork
+//----------------------------------------------------------------------
+
+AddrSpace::AddrSpace(AddrSpace *parent)
+{
+    numPages = parent->numPages;
+    exeName = new char[strlen(parent->exeName) + 1];
+    strcpy(exeName, parent->exeName);
+    exeFile = fileSystem->Open(exeName);	// our own seek position
+    ASSERT(exeFile != NULL);
+    code = parent->code;
+    initData = parent->initData;
+    text = parent->text;
+    textCache->Share(text);
+    mapBase = parent->mapBase;
+    stackLimit = parent->stackLimit;
+    heapStart = parent->heapStart;
+    brk = parent->brk;
+    swapPages = parent->swapPages;
+    swapBase = swapMap->ReserveExtent(swapPages);
+    readBuffer = new char[clusterSize * PageSize];
+    writeBuffer = new char[clusterSize * PageSize];
+    readCount = 0;
+
+    DEBUG('a', "Forking address space for %s, num pages %d\n", 
+					exeName, numPages);
+    pageTable = new PageTable(numPages);
+    mapped = new MappedFile*[MapRegionPages];
+    for (int m = 0; m < MapRegionPages; m++)
+	mapped[m] = NULL;
+    asid = (tlbManager != NULL) ? tlbManager->AllocASID() : 0;
+    pid = -1;
+    faultCounts = NULL;
+    userTime = 0;
+    resumedAt = stats->userTicks;
+    numResident = lastFault = wanted = 0;
+    lastFaultPage = -1;
+    faultStride = strideRun = 0;
+    suspended = growing = FALSE;
+    resume = new Semaphore("resume", 0);
+    openFiles = new OpenFile*[MaxOpenFiles];
+    for (int f = 0; f < MaxOpenFiles; f++)
+	openFiles[f] = NULL;
+    coreMap->ForkSpace(parent, this);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::InheritPages
+// 	Copy where each page of "parent" is kept, for a child just
+//	forked from it: the same part of the executable, the same swap
+//	slot (now shared), or nothing yet.  Pages in memory are shared
+//	separately, by the core map.  Mapped files stay with the parent.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::InheritPages(AddrSpace *parent)
+{
+    TranslationEntry *entry;
+    PageInfo *info;
+
+    for (int vpn = parent->NextUsedPage(0); vpn != -1;
+				vpn = parent->NextUsedPage(vpn + 1)) {
+	entry = pageTable->Entry(vpn);
+	*entry = *parent->pageTable->Entry(vpn);
+	entry->valid = FALSE;
+	entry->use = entry->dirty = FALSE;
+	info = pageTable->Info(vpn);
+	*info = *parent->pageTable->Info(vpn);
+	if (info->backing == InFile)
+	    info->backing = ZeroFill;
+	if (info->swapSlot != -1)
+	    swapMap->Share(info->swapSlot);
     }
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::SetCopyOnWrite
+// 	Make virtual page "vpn" read-only because its frame is shared
+//	("on"), or writable again, as the frame is now ours alone.
+//	Pages of code stay read-only regardless.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::SetCopyOnWrite(int vpn, bool on)
+{
+    TranslationEntry *entry = pageTable->Entry(vpn);
+    PageInfo *info = pageTable->Info(vpn);
+
+    if (entry->readOnly && !info->copyOnWrite)
+	return;				// code
+    info->copyOnWrite = on;
+    entry->readOnly = on;
+    if (tlbManager != NULL)		// the TLB has the old protection
+	tlbManager->Invalidate(entry);
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space.  The modified pages of its mapped
+//	files are written back; the rest of its page frames go back to
+//	the core map, without writing anything back, and its swap slots
+//	are freed.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
+   if (mapped != NULL)
+	for (int m = 0; m < MapRegionPages; m++)
+	    if (mapped[m] != NULL && mapped[m]->firstPage == mapBase + m)
+		Unmap((mapBase + m) * PageSize);
+   if (exeFile != NULL)			// demand paged
+	coreMap->FreeSpace(this);
+   if (refTrace != NULL && pid != -1)
+	refTrace->Exited(pid);
+   if (tlbManager != NULL)
+	tlbManager->FreeASID(asid);
+   if (exeFile != NULL)
+	for (int vpn = pageTable->NextUsed(0); vpn != -1;
+				vpn = pageTable->NextUsed(vpn + 1))
+	    if (pageTable->Info(vpn)->swapSlot != -1)
+		swapMap->Free(pageTable->Info(vpn)->swapSlot);
+   DEBUG('a', "Page table: %d of %d second-level tables used\n",
+		pageTable->GetNumTables(), pageTable->GetNumSpans());
    delete pageTable;
+   delete exeFile;
+   delete [] readBuffer;
+   delete [] writeBuffer;
+   delete [] exeName;
+   if (text != NULL)
+	textCache->Detach(text);
+   delete resume;
+   for (int f = 0; f < MaxOpenFiles; f++)
+	delete openFiles[f];
+   delete [] openFiles;
+   delete [] mapped;
+   if (swapBase >= 0)
+	swapMap->ReleaseExtent(swapBase, swapPages);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ReadCluster
+// 	Called on a fault on virtual page "vpn".  If the page is in swap,
+//	read it together with the pages that follow it in the swap area
+//	and are also waiting there, up to clusterSize pages, with a
+//	single disk request.  The pages are kept in readBuffer until
+//	LoadPage puts them in their frames.
+//
+//	Return the number of pages, starting at "vpn", to be loaded.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::ReadCluster(int vpn)
+{
+    PageInfo *info = pageTable->Info(vpn), *next;
+    TranslationEntry *entry;
+    int count = 1;
+
+    if (info->backing != InSwap)
+	return 1;
+    while (count < clusterSize && vpn + count < (int) numPages) {
+	entry = pageTable->Lookup(vpn + count);
+	if (entry == NULL || entry->valid)
+	    break;
+	next = pageTable->Info(vpn + count);
+	if (next->backing != InSwap || next->swapSlot != info->swapSlot + count)
+	    break;
+	count++;
+    }
+    if (count > 1) {
+	swapMap->Read(info->swapSlot, readBuffer, count);
+	stats->numClusterReads += count - 1;
+	readFirst = vpn;
+	readCount = count;
+    }
+    return count;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::IsOnDisk
+// 	Return TRUE if virtual page "vpn" has been used but is not in
+//	memory, and bringing it in means reading it (it is not just
+//	all zeroes); that is, if it is worth reading ahead.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::IsOnDisk(int vpn)
+{
+    TranslationEntry *entry;
+
+    if (!InAddressSpace(vpn))
+	return FALSE;
+    entry = pageTable->Lookup(vpn);
+    if (entry == NULL || entry->valid)
+	return FALSE;
+    return pageTable->Info(vpn)->backing != ZeroFill;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::IsModified
+// 	Return TRUE if virtual page "vpn" has contents of its own, which
+//	a checkpoint must save: it has been written out to swap, or it
+//	is in memory and modified.  The other pages are all zeroes, or
+//	still as they are in the program or in their mapped file.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::IsModified(int vpn)
+{
+    TranslationEntry *entry = pageTable->Lookup(vpn);
+    PageInfo *info;
+
+    if (entry == NULL)
+	return FALSE;
+    info = pageTable->Info(vpn);
+    if (info->backing == InFile)
+	return FALSE;
+    return info->backing == InSwap || (entry->valid && entry->dirty);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyPages
+// 	Copy the "count" modified virtual pages listed in "vpns" (see
+//	IsModified) into "into", one after the other: from their frames
+//	if they are in memory, otherwise from swap, reading pages in
+//	consecutive slots with a single request.  Nothing is brought
+//	into memory, or marked clean.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::CopyPages(int *vpns, int count, char *into)
+{
+    TranslationEntry *entry;
+    int slot, run;
+
+    for (int i = 0; i < count; i += run) {
+	entry = pageTable->Entry(vpns[i]);
+	run = 1;
+	if (entry->valid) {
+	    bcopy(&(machine->mainMemory[entry->physicalPage * PageSize]),
+			&into[i * PageSize], PageSize);
+	    continue;
+	}
+	slot = pageTable->Info(vpns[i])->swapSlot;
+	while (i + run < count && !pageTable->Entry(vpns[i + run])->valid
+		&& pageTable->Info(vpns[i + run])->swapSlot == slot + run)
+	    run++;
+	swapMap->Read(slot, &into[i * PageSize], run);
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::RestorePages
+// 	Put the contents of the "count" virtual pages listed in "vpns",
+//	one after the other in "from", in swap, where they are paged in
+//	from when they are referenced.  Each page gets its slot in our
+//	extent, if it has one, so pages in consecutive slots are written
+//	with a single request.  The pages must not have been used yet.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::RestorePages(int *vpns, int count, char *from)
+{
+    PageInfo *info;
+    int slot, run;
+
+    for (int i = 0; i < count; i++) {
+	info = pageTable->Info(vpns[i]);
+	ASSERT(info->swapSlot == -1);
+	info->swapSlot = swapMap->Allocate(SlotHint(vpns[i]));
+	info->backing = InSwap;
+    }
+    for (int i = 0; i < count; i += run) {
+	slot = pageTable->Info(vpns[i])->swapSlot;
+	for (run = 1; i + run < count
+		&& pageTable->Info(vpns[i + run])->swapSlot == slot + run; run++)
+	    ;
+	swapMap->Write(slot, &from[i * PageSize], run);
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadPage
+// 	Bring virtual page "vpn" into physical page "frame": read it from
+//	the swap file if it has ever been there, or from its mapped file,
+//	otherwise just clear the frame.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadPage(int vpn, int frame)
+{
+    TranslationEntry *entry = pageTable->Entry(vpn);
+    PageInfo *info = pageTable->Info(vpn);
+    char *where = &(machine->mainMemory[frame * PageSize]);
+
+    bzero(where, PageSize);
+    if (readCount > 0 && vpn >= readFirst && vpn < readFirst + readCount) {
+	bcopy(&readBuffer[(vpn - readFirst) * PageSize], where, PageSize);
+	if (vpn == readFirst + readCount - 1)
+	    readCount = 0;			// the cluster is all loaded
+    } else switch (info->backing) {
+      case InSwap:
+	swapMap->Read(info->swapSlot, where, 1);
+	break;
+      case InExecutable:		// initData overrides code, as when
+	ReadSegment(&code, vpn, 1, where);	// loading the whole
+	ReadSegment(&initData, vpn, 1, where);	// program
+	stats->numDiskReads++;
+	break;
+      case InFile: {
+	MappedFile *m = mapped[vpn - mapBase];
+
+	m->file->ReadAt(where, PageSize, (vpn - m->firstPage) * PageSize);
+	stats->numDiskReads++;		// the end of the last page stays
+	break;				// zero
+      }
+      case ZeroFill:
+	stats->numZeroFills++;
+	break;
+    }
+    entry->physicalPage = frame;
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+    entry->valid = TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CanPromote
+// 	Return TRUE if the superpage that virtual page "vpn" falls in
+//	can be brought in at once: it lies within the program (code,
+//	initialized and uninitialized data, which are laid out one after
+//	the other), and none of its pages has been in memory since it
+//	was last read from the executable, so they all come from there,
+//	or are zeroes.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CanPromote(int vpn)
+{
+    int base = vpn - vpn % superPageSize;
+    TranslationEntry *entry;
+    PageBacking backing;
+
+    if (exeFile == NULL
+		|| base + superPageSize > (int) divRoundUp(heapStart, PageSize))
+	return FALSE;
+    for (int i = base; i < base + superPageSize; i++) {
+	entry = pageTable->Entry(i);
+	backing = pageTable->Info(i)->backing;
+	if (entry->valid || (backing != InExecutable && backing != ZeroFill))
+	    return FALSE;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadSuperPage
+// 	Bring the superpage that virtual page "vpn" falls in into the
+//	consecutive page frames from "frame" on.  The part of each
+//	segment of the executable it covers is read with one request,
+//	straight into the frames; the rest is zero filled.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadSuperPage(int vpn, int frame)
+{
+    int base = vpn - vpn % superPageSize;
+    char *where = &(machine->mainMemory[frame * PageSize]);
+    TranslationEntry *entry;
+
+    bzero(where, superPageSize * PageSize);
+    if (ReadSegment(&code, base, superPageSize, where))	// initData
+	stats->numDiskReads++;			// overrides code, as in
+    if (ReadSegment(&initData, base, superPageSize, where))	// LoadPage
+	stats->numDiskReads++;
+    for (int i = 0; i < superPageSize; i++) {
+	entry = pageTable->Entry(base + i);
+	if (pageTable->Info(base + i)->backing == ZeroFill)
+	    stats->numZeroFills++;
+	entry->physicalPage = frame + i;
+	entry->use = FALSE;
+	entry->dirty = FALSE;
+	entry->valid = TRUE;
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SuperPageOf
+// 	Return the first page of the superpage that virtual page "vpn"
+//	falls in, if all of it is in memory, in consecutive frames
+//	starting at a multiple of the superpage size, with the same
+//	protection; otherwise (or without superpages) return -1.  Once a
+//	page of a superpage is evicted, the superpage has been demoted:
+//	its other pages are mapped one by one.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SuperPageOf(int vpn)
+{
+    int base;
+    TranslationEntry *first, *entry;
+
+    if (superPageSize == 0)
+	return -1;
+    base = vpn - vpn % superPageSize;
+    if (base + superPageSize > (int) numPages)
+	return -1;
+    first = pageTable->Lookup(base);
+    if (first == NULL || !first->valid
+		|| first->physicalPage % superPageSize != 0)
+	return -1;
+    for (int i = 1; i < superPageSize; i++) {
+	entry = &first[i];		// the same second-level table
+	if (!entry->valid || entry->physicalPage != first->physicalPage + i
+		|| entry->readOnly != first->readOnly)
+	    return -1;
+    }
+    return base;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ReadSegment
+// 	Read the part of segment "seg" of the executable that falls in
+//	the "pages" virtual pages from "vpn" on into the page frames at
+//	"where", with a single request.  Return TRUE if there was any.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::ReadSegment(Segment *seg, int vpn, int pages, char *where)
+{
+    int start = vpn * PageSize, end = start + pages * PageSize;
+
+    if (seg->virtualAddr > start)
+	start = seg->virtualAddr;
+    if (seg->virtualAddr + seg->size < end)
+	end = seg->virtualAddr + seg->size;
+    if (start >= end)
+	return FALSE;
+    exeFile->ReadAt(where + start - vpn * PageSize, end - start,
+			seg->inFileAddr + start - seg->virtualAddr);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::EvictPage
+// 	Take virtual page "vpn" out of memory.  Only a page that was
+//	modified needs to be written to the swap file; a clean page is
+//	still in the swap file or the executable, or all zeroes.  A
+//	modified page of a mapped file is written back to the file.
+//
+//	A page gets its swap slot the first time it is written: its slot
+//	in the address space's extent (see SlotHint), if that is free.
+//
+//	A dirty page is written together with the dirty pages around it
+//	that are in memory and whose slots follow on from its own, up to
+//	clusterSize pages in all, with a single disk request; those pages
+//	stay in memory, but are now clean.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::EvictPage(int vpn)
+{
+    TranslationEntry *entry = pageTable->Entry(vpn);
+    PageInfo *info = pageTable->Info(vpn);
+
+    entry->valid = FALSE;
+    if (tlbManager != NULL)
+	tlbManager->Invalidate(entry);
+    if (info->backing == InFile) {
+	if (entry->dirty) {
+	    MappedFile *m = mapped[vpn - mapBase];
+	    int offset = (vpn - m->firstPage) * PageSize;
+
+	    m->file->WriteAt(&(machine->mainMemory[entry->physicalPage
+						    * PageSize]),
+			     min(PageSize, m->length - offset), offset);
+	    entry->dirty = FALSE;
+	    stats->numDiskWrites++;
+	}
+	return;
+    }
+    if (entry->dirty) {
+	int first = vpn, last = vpn, i;
+
+	if (info->swapSlot != -1 && swapMap->IsShared(info->swapSlot)) {
+	    swapMap->Free(info->swapSlot);	// the old copy is not ours
+	    info->swapSlot = -1;		// alone any more
+	}
+	if (info->swapSlot == -1)
+	    info->swapSlot = swapMap->Allocate(SlotHint(vpn));
+	while (last - first + 1 < clusterSize && first > 0
+		&& IsDirtyInMemory(first - 1)
+		&& TakeSlot(first - 1, info->swapSlot - (vpn - first + 1)))
+	    first--;
+	while (last - first + 1 < clusterSize && last + 1 < (int) numPages
+		&& IsDirtyInMemory(last + 1)
+		&& TakeSlot(last + 1, info->swapSlot + (last + 1 - vpn)))
+	    last++;
+	for (i = first; i <= last; i++) {
+	    entry = pageTable->Entry(i);
+	    bcopy(&(machine->mainMemory[entry->physicalPage * PageSize]),
+			&writeBuffer[(i - first) * PageSize], PageSize);
+	    pageTable->Info(i)->backing = InSwap;
+	    entry->dirty = FALSE;
+	}
+	swapMap->Write(pageTable->Info(first)->swapSlot, writeBuffer,
+			last - first + 1);
+	stats->numClusterWrites += last - first;
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AddFile
+// 	Enter "file" in the open file table of this address space.
+//	Return its OpenFileId, or -1 if the table is full.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::AddFile(OpenFile *file)
+{
+    for (int id = ConsoleOutput + 1; id < MaxOpenFiles; id++)
+	if (openFiles[id] == NULL) {
+	    openFiles[id] = file;
+	    return id;
+	}
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::GetFile
+// 	Return the open file "id", or NULL if there is none (the console
+//	has no OpenFile).
+//----------------------------------------------------------------------
+
+OpenFile *
+AddrSpace::GetFile(int id)
+{
+    if (id < 0 || id >= MaxOpenFiles)
+	return NULL;
+    return openFiles[id];
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CloseFile
+// 	Close the open file "id".  Return FALSE if there is none.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CloseFile(int id)
+{
+    OpenFile *file = GetFile(id);
+
+    if (file == NULL)
+	return FALSE;
+    delete file;
+    openFiles[id] = NULL;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Map
+// 	Map all of "file" into the pages above the stack, at the first
+//	place it fits.  Nothing is read now: its pages are faulted in
+//	from the file like any other, and written back to it when they
+//	are evicted or unmapped.  The file does not grow; anything
+//	stored beyond its end, in its last page, is lost.
+//
+//	Return the virtual address of the mapping, or 0 if there is not
+//	enough room (the address space keeps "file" only if it is
+//	mapped).
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Map(OpenFile *file)
+{
+    MappedFile *m;
+    int length = file->Length(), pages = divRoundUp(length, PageSize);
+    int i, run = 0;
+
+    if (mapped == NULL || pages == 0)
+	return 0;
+    for (i = 0; i < MapRegionPages && run < pages; i++)
+	run = (mapped[i] == NULL) ? run + 1 : 0;
+    if (run < pages)
+	return 0;
+
+    m = new MappedFile;
+    m->file = file;
+    m->firstPage = mapBase + i - pages;
+    m->numPages = pages;
+    m->length = length;
+    for (i = m->firstPage; i < m->firstPage + pages; i++) {
+	mapped[i - mapBase] = m;
+	pageTable->Info(i)->backing = InFile;
+    }
+    DEBUG('a', "Mapped %d bytes at 0x%x\n", length, m->firstPage * PageSize);
+    return m->firstPage * PageSize;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Unmap
+// 	Write back the modified pages of the file mapped at virtual
+//	address "addr", free its frames, and close it.  Return FALSE if
+//	no file is mapped there.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::Unmap(int addr)
+{
+    int vpn = addr / PageSize;
+    MappedFile *m;
+
+    if (mapped == NULL || addr % PageSize != 0 || vpn < mapBase
+		|| vpn >= (int) numPages)
+	return FALSE;
+    m = mapped[vpn - mapBase];
+    if (m == NULL || m->firstPage != vpn)
+	return FALSE;
+    coreMap->FlushPages(this, vpn, m->numPages, FALSE);
+    for (int i = vpn; i < vpn + m->numPages; i++) {
+	mapped[i - mapBase] = NULL;
+	pageTable->Info(i)->backing = ZeroFill;
+    }
+    delete m->file;
+    delete m;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::HasMappedFiles
+// 	Is any file still mapped with Map?
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::HasMappedFiles()
+{
+    if (mapped == NULL)
+	return FALSE;
+    for (int i = 0; i < MapRegionPages; i++)
+	if (mapped[i] != NULL)
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Sbrk
+// 	Grow the heap by "increment" bytes (or shrink it, if negative),
+//	and return the old break.  The pages added cost nothing until
+//	they are referenced, when they are zero filled; the pages given
+//	back are thrown away, frames, swap slots and all.
+//
+//	Return -1, leaving the break alone, if the heap would run into
+//	the room left for the stack, or below the program's own data.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Sbrk(int increment)
+{
+    int old = brk, first, last;
+    PageInfo *info;
+
+    if (exeFile == NULL || brk + increment < heapStart
+	    || (int) divRoundUp(brk + increment, PageSize) > stackLimit)
+	return -1;
+    brk += increment;
+    first = divRoundUp(brk, PageSize);		// pages given back
+    last = divRoundUp(old, PageSize);
+    if (first < last) {
+	coreMap->FlushPages(this, first, last - first, TRUE);
+	for (int vpn = first; vpn < last; vpn++)
+	    if (pageTable->Lookup(vpn) != NULL) {
+		info = pageTable->Info(vpn);
+		if (info->swapSlot != -1)
+		    swapMap->Free(info->swapSlot);
+		info->swapSlot = -1;
+		info->backing = ZeroFill;
+		SetCopyOnWrite(vpn, FALSE);
+	    }
+    }
+    DEBUG('a', "Break moved from 0x%x to 0x%x\n", old, brk);
+    return old;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::InAddressSpace
+// 	Return TRUE if virtual page "vpn" can be referenced: it is in the
+//	program or the heap, in the room for the stack, or in a mapped
+//	file.  Any page of the stack's room can be used, so the stack
+//	grows as deep as the program goes, up to UserStackMax bytes.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::InAddressSpace(int vpn)
+{
+    if (vpn < 0 || vpn >= (int) numPages)
+	return FALSE;
+    if (vpn >= mapBase)
+	return mapped[vpn - mapBase] != NULL;
+    return vpn < (int) divRoundUp(brk, PageSize) || vpn >= stackLimit;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::VirtualTime
+// 	Return how long this address space has run user code, in user
+//	ticks (instructions).  Only valid while it is running, as when
+//	it takes a page fault.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::VirtualTime()
+{
+    return userTime + stats->userTicks - resumedAt;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::TakeSlot
+// 	Return TRUE if virtual page "vpn" is (or can now be) stored in
+//	swap slot "slot", so that it can be written in the same request
+//	as its neighbours.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::TakeSlot(int vpn, int slot)
+{
+    PageInfo *info = pageTable->Info(vpn);
+
+    if (info->backing == InFile)
+	return FALSE;			// goes back to its file
+    if (info->swapSlot != -1 && swapMap->IsShared(info->swapSlot))
+	return FALSE;			// written alone, to a new slot
+    if (info->swapSlot == -1 && swapMap->IsFree(slot))
+	info->swapSlot = swapMap->Allocate(slot);
+    return info->swapSlot == slot;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SlotHint
+// 	Return the slot of virtual page "vpn" in our extent of the swap
+//	area, or -1 if it has none.  The extent holds the pages of the
+//	program, and then the top UserStackSize bytes of the stack, in
+//	address order, so that neighbours can be written out together.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SlotHint(int vpn)
+{
+    int programPages = divRoundUp(heapStart, PageSize);
+    int stackBase = mapBase - (swapPages - programPages);
+
+    if (swapBase < 0)
+	return -1;
+    if (vpn < programPages)
+	return swapBase + vpn;
+    if (vpn >= stackBase && vpn < mapBase)
+	return swapBase + programPages + vpn - stackBase;
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::IsDirtyInMemory
+// 	Return TRUE if virtual page "vpn" is in memory and modified, and
+//	so can be written out along with a neighbour being evicted.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::IsDirtyInMemory(int vpn)
+{
+    TranslationEntry *entry = pageTable->Lookup(vpn);
+
+    return entry != NULL && entry->valid && entry->dirty;
 }
 
 //----------------------------------------------------------------------
@@ -203,11 +1094,11 @@ AddrSpace::InitRegisters()
     // of branch delay possibility
     machine->WriteRegister(NextPCReg, 4);
 
-   // Set the stack register to the end of the address space, where we
-   // allocated the stack; but subtract off a bit, to make sure we don't
-   // accidentally reference off the end!
-    machine->WriteRegister(StackReg, numPages * PageSize - 16);
-    DEBUG('a', "Initializing stack register to %d\n", numPages * PageSize - 16);
+   // Set the stack register to the end of the address space (below the
+   // pages for mapped files), where we allocated the stack; but subtract
+   // off a bit, to make sure we don't accidentally reference off the end!
+    machine->WriteRegister(StackReg, mapBase * PageSize - 16);
+    DEBUG('a', "Initializing stack register to %d\n", mapBase * PageSize - 16);
 }
 
 //----------------------------------------------------------------------
@@ -215,39 +1106,35 @@ AddrSpace::InitRegisters()
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, nothing!
+//	Also stop our clock.  With a TLB, the use and dirty bits the
+//	hardware set in it belong in our page table.
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState() 
-{}
+{
+    userTime += stats->userTicks - resumedAt;
+    if (tlbManager != NULL)
+	tlbManager->SyncBits();
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::RestoreState
 // 	On a context switch, restore the machine state so that
-//	this address space can run.
+//	this address space can run, and start our clock.
 //
-//      For now, tell the machine where to find the page table.
+//      Without a TLB, tell the machine where to find the page table
+//	directory.
+//	With one, load our address space id (or flush the TLB); misses
+//	are refilled from the page table by the kernel.
 //----------------------------------------------------------------------
 
 void AddrSpace::RestoreState() 
 {
-    machine->pageTable = pageTable;
-    machine->pageTableSize = numPages;
-}
-
-//metodo de menu utilizado para mostrar las opciones de algoritmo y
-//que el usuario seleccione una
-void AddrSpace::MenuAlgoritmos()
-{
-	do{
-		printf("\n\n\aSeleccione un Algoritmo de Reemplazo:\a\n\n");
-		printf("\n\n\aSeleccione un Algoritmo de Reemplazo:\a\n\n");
-		printf("1.- FIFO\n");
-		printf("2.- RELOJ\n");
-		printf("3.- LRU\n");
-		printf("Escriba una opción: ");
-		scanf("%d",&numAlgoritmo);
-		printf("\n");       
-	}while(numAlgoritmo > 3 || numAlgoritmo == 0);
+    resumedAt = stats->userTicks;
+    if (tlbManager != NULL) {
+	tlbManager->SwitchTo(asid);
+	return;
+    }
+    machine->pageDirectory = pageTable->GetDirectory();
+    machine->pageDirectorySize = pageTable->GetNumSpans();
 }
-
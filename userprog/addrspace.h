@@ -15,8 +15,29 @@
 
 #include "copyright.h"
 #include "filesys.h"
+#include "noff.h"
+#include "pagetable.h"
+
+class Semaphore;
+class ProcessFaults;
+class SharedText;
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define UserSpaceSize	(1024 * 1024)	// bytes of virtual address space
+#define UserStackMax	(64 * 1024)	// the stack can grow to this
+#define MaxOpenFiles		16	// per address space; ids 0 and 1
+					// are the console
+#define MapRegionPages		64	// virtual pages above the stack, for
+					// files mapped with Map
+
+// A file mapped into an address space by the Map system call
+class MappedFile {
+  public:
+    OpenFile *file;			// our own open file
+    int firstPage;			// where it is mapped
+    int numPages;
+    int length;				// of the file, in bytes
+};
 
 class AddrSpace {
   public:
@@ -24,6 +45,8 @@ class AddrSpace {
     AddrSpace(OpenFile *executable, char* filename);	// Create an address space,
 					// initializing it with the program
 					// stored in the file "executable"
+    AddrSpace(AddrSpace *parent);	// Fork a copy-on-write copy of
+					// "parent"
     ~AddrSpace();			// De-allocate an address space
 
     void InitRegisters();		// Initialize user-level CPU registers,
@@ -31,13 +54,119 @@ class AddrSpace {
 
     void SaveState();			// Save/restore address space-specific
     void RestoreState();		// info on a context switch 
-    void MenuAlgoritmos();
+
+    int ReadCluster(int vpn);		// read ahead the pages after "vpn",
+					// return how many to bring in
+    void LoadPage(int vpn, int frame);	// bring a page into memory
+    bool CanPromote(int vpn);		// can the superpage of "vpn" be
+					// brought in all at once?
+    void LoadSuperPage(int vpn, int frame);	// do it, at "frame"
+    int SuperPageOf(int vpn);		// first page of the superpage of
+					// "vpn", if it is intact, or -1
+    void EvictPage(int vpn);		// take a page out of memory
+    void InheritPages(AddrSpace *parent);	// where our pages are, as
+					// a child of "parent"
+
+    SharedText *GetText() { return text; }	// our code, if shared
+    bool IsSharedText(int vpn)		// a page of nothing but code?
+	{ return text != NULL && pageTable->Entry(vpn)->readOnly
+				&& !pageTable->Info(vpn)->copyOnWrite; }
+    bool IsCopyOnWrite(int vpn) { return pageTable->Info(vpn)->copyOnWrite; }
+    void SetCopyOnWrite(int vpn, bool on);	// share "vpn" read-only,
+					// or make it writable again
+
+    int Map(OpenFile *file);		// map "file" in; return its address,
+					// or 0 if there is no room
+    bool Unmap(int addr);		// write back and unmap the file
+					// mapped at "addr"
+    bool HasMappedFiles();		// is any file mapped?
+    int Sbrk(int increment);		// move the break; return the old
+					// one, or -1 if there is no room
+    bool InAddressSpace(int vpn);	// can "vpn" be referenced?
+    bool IsOnDisk(int vpn);		// out of memory, but not all zeroes?
+    bool IsModified(int vpn);		// neither in the program nor all
+					// zeroes (nor in a mapped file)?
+    void CopyPages(int *vpns, int count, char *into);
+					// copy out these modified pages
+    void RestorePages(int *vpns, int count, char *from);
+					// put these pages in swap
+
+    TranslationEntry *GetEntry(int vpn)	// page table entry of "vpn"
+	{ return pageTable->Entry(vpn); }
+    TranslationEntry *FindEntry(int vpn)	// the same, or NULL if it
+	{ return pageTable->Lookup(vpn); }	// was never used
+    int NextUsedPage(int vpn)		// to visit every page in use
+	{ return pageTable->NextUsed(vpn); }
+    unsigned int GetNumPages() { return numPages; }
+    int GetASID() { return asid; }	// TLB tag of this address space
+    int GetPid() { return pid; }	// SpaceId, or -1 if it has none
+    char *GetName() { return exeName; }	// program, NULL if not known
+    void SetPid(int id) { pid = id; }	// (see proctable.h)
+
+    int AddFile(OpenFile *file);	// open file table: return the id
+    OpenFile *GetFile(int id);		// for "file", or NULL/-1 if there
+    bool CloseFile(int id);		// is no such file
+
+    int VirtualTime();			// user ticks this address space has
+					// run for; it must be running
+
+    // Kept by the core map, to size our resident set (see coremap.h)
+    int numResident;			// frames holding our pages
+    int lastFault;			// VirtualTime() of our last fault
+    bool growing;			// was it within pffInterval of the
+					// one before?
+    bool suspended;			// swapped out, for lack of memory
+    int wanted;				// when suspended, the frames we had
+    Semaphore *resume;			// where our thread waits meanwhile
+    int lastFaultPage;			// the last page that faulted
+    int faultStride;			// prefetching: its distance from
+    int strideRun;			// the one before, and how many
+					// faults in a row were that far apart
+
+    ProcessFaults *faultCounts;		// our line in the fault log, if any
 
   private:
-    TranslationEntry *pageTable;	// Assume linear page table translation
-					// for now!
+    PageTable *pageTable;		// two-level, allocated as pages are
+					// used
     unsigned int numPages;		// Number of pages in the virtual 
 					// address space
+    int heapStart;			// end of the program's own data
+    int brk;				// and of the heap (the "break")
+    int stackLimit;			// lowest page the stack can grow to
+    int asid;				// address space id, when the
+					// machine has a TLB
+    int pid;				// our entry in the process table
+    int userTime;			// user ticks up to the last switch
+    int resumedAt;			// stats->userTicks when we were last
+					// switched to
+    int swapBase;			// extent reserved in the swap area
+					// for the program's pages, -1 if
+					// there was no room
+    int swapPages;			// how many it has
+    OpenFile *exeFile;			// the program, open while it runs
+    char *exeName;			// and its name, for forked children
+    SharedText *text;			// our code, in the text cache
+    OpenFile **openFiles;		// indexed by OpenFileId
+    int mapBase;			// first page above the stack
+    MappedFile **mapped;		// file mapped at each page from
+					// there on, if any
+    Segment code, initData;		// where the program's pages are
+					// in "exeFile"
+
+    bool ReadSegment(Segment *seg, int vpn, int pages, char *where);
+					// read the part of "seg" in these
+					// pages
+    char *readBuffer;			// pages read by ReadCluster,
+    int readFirst, readCount;		// not yet loaded
+    char *writeBuffer;			// pages being written by EvictPage
+    bool TakeSlot(int vpn, int slot);	// put "vpn" in "slot", if possible
+    int SlotHint(int vpn);		// slot of "vpn" in our extent
+    bool IsDirtyInMemory(int vpn);	// to be written out with its
+					// neighbours?
 };
 
+extern bool IsExecutable(OpenFile *executable);
+					// can an address space be made for
+					// this program?
+
 #endif // ADDRSPACE_H
@@ -0,0 +1,220 @@
+// checkpoint.cc
+//	Routines to save a user process to a Nachos file, and to load it
+//	back.  See checkpoint.h for the format.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "checkpoint.h"
+
+//----------------------------------------------------------------------
+// WordsToHost
+// 	Convert "count" words of a checkpoint between the byte order of
+//	the file (little endian) and that of the host, in place.  The
+//	conversion is its own inverse.
+//----------------------------------------------------------------------
+
+static void
+WordsToHost(int *words, int count)
+{
+    for (int i = 0; i < count; i++)
+	words[i] = WordToHost(words[i]);
+}
+
+//----------------------------------------------------------------------
+// WriteAll, ReadAll
+// 	Move "size" bytes to or from the current position of "file",
+//	with a single request.  Return FALSE if they did not all fit.
+//----------------------------------------------------------------------
+
+static bool
+WriteAll(OpenFile *file, char *from, int size)
+{
+    return file->Write(from, size) == size;
+}
+
+static bool
+ReadAll(OpenFile *file, char *into, int size)
+{
+    return file->Read(into, size) == size;
+}
+
+//----------------------------------------------------------------------
+// TakeCheckpoint
+// 	Save the address space "space" to the Nachos file "name", which
+//	is replaced if it already exists, so that the process can be
+//	resumed from there with the registers "registers".  The process
+//	must be the one running, and stays stopped meanwhile; the pages
+//	saved may still be evicted while it waits for the disk, which
+//	only changes where they are read from.
+//
+//	Return FALSE if the address space is not demand paged (there
+//	is no program to page it back in from), if it has a file mapped
+//	(which a restored process could not find again), or if the file
+//	cannot be written.
+//----------------------------------------------------------------------
+
+bool
+TakeCheckpoint(char *name, AddrSpace *space, int *registers)
+{
+    int since = stats->totalTicks;
+    char *program = space->GetName();
+    CheckpointHeader header;
+    int *pages, *words;
+    int numSaved = 0, size, i, count;
+    char *buffer;
+    OpenFile *file = NULL;
+    bool ok;
+
+    if (program == NULL || space->HasMappedFiles())
+	return FALSE;
+    if (tlbManager != NULL)		// get the latest dirty bits
+	tlbManager->SyncBits();
+    pages = new int[space->GetNumPages()];
+    for (int vpn = space->NextUsedPage(0); vpn != -1;
+				vpn = space->NextUsedPage(vpn + 1))
+	if (space->IsModified(vpn))
+	    pages[numSaved++] = vpn;
+
+    header.magic = CheckpointMagic;
+    header.pageSize = PageSize;
+    header.brk = space->Sbrk(0);
+    header.numSaved = numSaved;
+    header.nameLength = strlen(program) + 1;
+    for (i = 0; i < NumTotalRegs; i++)
+	header.registers[i] = registers[i];
+    WordsToHost((int *) &header, sizeof(header) / sizeof(int));
+    size = sizeof(header) + strlen(program) + 1
+		+ numSaved * ((int) sizeof(int) + PageSize);
+
+    fileSystem->Remove(name);		// the file cannot grow, so make a
+    if (fileSystem->Create(name, size))	// new one, just big enough
+	file = fileSystem->Open(name);
+    if (file == NULL) {
+	delete [] pages;
+	return FALSE;
+    }
+
+    words = new int[numSaved];
+    for (i = 0; i < numSaved; i++)
+	words[i] = pages[i];
+    WordsToHost(words, numSaved);
+    ok = WriteAll(file, (char *) &header, sizeof(header))
+	    && WriteAll(file, program, strlen(program) + 1)
+	    && WriteAll(file, (char *) words, numSaved * sizeof(int));
+    buffer = new char[CheckpointChunk * PageSize];
+    for (i = 0; ok && i < numSaved; i += count) {
+	count = min(CheckpointChunk, numSaved - i);
+	space->CopyPages(&pages[i], count, buffer);
+	ok = WriteAll(file, buffer, count * PageSize);
+    }
+    delete file;
+    delete [] buffer;
+    delete [] words;
+    delete [] pages;
+
+    DEBUG('a', "Checkpoint of %s to %s: %d pages saved\n", program, name,
+		numSaved);
+    if (ok) {
+	stats->numCheckpoints++;
+	stats->checkpointPages += numSaved;
+	stats->checkpointTicks += stats->totalTicks - since;
+    }
+    return ok;
+}
+
+//----------------------------------------------------------------------
+// ReadHeader
+// 	Read the header of the checkpoint in "file", and the name of its
+//	program, into "header" and a new string "program".  Return FALSE
+//	if it is not a checkpoint this machine can resume.
+//----------------------------------------------------------------------
+
+static bool
+ReadHeader(OpenFile *file, CheckpointHeader *header, char **program)
+{
+    *program = NULL;
+    if (!ReadAll(file, (char *) header, sizeof(*header)))
+	return FALSE;
+    WordsToHost((int *) header, sizeof(*header) / sizeof(int));
+    if (header->magic != CheckpointMagic || header->pageSize != PageSize
+	    || header->nameLength <= 0 || header->nameLength > file->Length()
+	    || header->numSaved < 0
+	    || header->numSaved > file->Length() / PageSize)
+	return FALSE;
+    *program = new char[header->nameLength];
+    return ReadAll(file, *program, header->nameLength)
+	    && (*program)[header->nameLength - 1] == '\0';
+}
+
+//----------------------------------------------------------------------
+// LoadCheckpoint
+// 	Make a new address space for the process saved in the Nachos
+//	file "name": one for the same program, with the same break, and
+//	the saved pages in swap.  Nothing is brought into memory; the
+//	process pages itself back in when it runs.
+//
+//	Return the address space, and the registers to resume the
+//	process with in "registers"; or NULL if the file is not a
+//	checkpoint, or its program cannot be opened or loaded.
+//----------------------------------------------------------------------
+
+AddrSpace *
+LoadCheckpoint(char *name, int *registers)
+{
+    OpenFile *file = fileSystem->Open(name), *executable = NULL;
+    CheckpointHeader header;
+    AddrSpace *space;
+    char *program, *buffer;
+    int *pages;
+    int i, count;
+    bool ok;
+
+    if (file == NULL)
+	return NULL;
+    if (ReadHeader(file, &header, &program))
+	executable = fileSystem->Open(program);
+    if (executable != NULL && !IsExecutable(executable)) {
+	delete executable;
+	executable = NULL;
+    }
+    if (executable == NULL) {
+	delete [] program;
+	delete file;
+	return NULL;
+    }
+    space = new AddrSpace(executable, program);	// it closes the file
+
+    pages = new int[header.numSaved];
+    ok = space->Sbrk(header.brk - space->Sbrk(0)) != -1
+	    && ReadAll(file, (char *) pages, header.numSaved * sizeof(int));
+    WordsToHost(pages, header.numSaved);
+    for (i = 0; ok && i < header.numSaved; i++)	// in order, and each
+	ok = space->InAddressSpace(pages[i])	// one only once
+		&& (i == 0 || pages[i] > pages[i - 1]);
+    buffer = new char[CheckpointChunk * PageSize];
+    for (i = 0; ok && i < header.numSaved; i += count) {
+	count = min(CheckpointChunk, header.numSaved - i);
+	ok = ReadAll(file, buffer, count * PageSize);
+	if (ok)
+	    space->RestorePages(&pages[i], count, buffer);
+    }
+    delete file;
+    delete [] buffer;
+    delete [] pages;
+
+    DEBUG('a', "Checkpoint %s of %s: %d pages restored\n", name, program,
+		header.numSaved);
+    delete [] program;
+    if (!ok) {
+	delete space;			// gives back the swap slots taken
+	return NULL;
+    }
+    for (i = 0; i < NumTotalRegs; i++)
+	registers[i] = header.registers[i];
+    stats->numRestores++;
+    return space;
+}
@@ -0,0 +1,56 @@
+// checkpoint.h
+//	Data structures for saving a running user process to a file, and
+//	for starting it again from there: later, or after Nachos has been
+//	restarted.
+//
+//	A checkpoint is a Nachos file of little-endian words: a header
+//	(see CheckpointHeader), the name of the program, the numbers of
+//	the virtual pages saved, and then their contents, in the same
+//	order.  Only the pages the process has modified are saved; the
+//	others are still in the program, or all zeroes, and are paged in
+//	from there as usual once it resumes.  The pages are written in
+//	order, CheckpointChunk pages per request, whether they were in
+//	memory or in swap; a restored process finds them in swap, where
+//	they go back the same way.
+//
+//	Open files are not saved: a restored process only has the
+//	console, like a forked one.  A process with a file mapped cannot
+//	be checkpointed at all, as its mapped pages would come back with
+//	nothing behind them.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "copyright.h"
+#include "machine.h"
+
+class AddrSpace;
+
+#define CheckpointMagic	0x544b4843	// "CHKT" in the file
+#define CheckpointChunk	16		// pages per read or write
+
+// The first words of a checkpoint
+class CheckpointHeader {
+  public:
+    int magic;				// CheckpointMagic
+    int pageSize;			// of the machine that saved it
+    int brk;				// end of the heap
+    int numSaved;			// pages saved
+    int nameLength;			// of the program's name, with its
+					// null
+    int registers[NumTotalRegs];	// where the process left off
+};
+
+extern bool TakeCheckpoint(char *name, AddrSpace *space, int *registers);
+					// save "space", to be resumed with
+					// these registers
+extern AddrSpace *LoadCheckpoint(char *name, int *registers);
+					// the address space saved in "name",
+					// and its registers; NULL if it
+					// cannot be read
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,942 @@
+// coremap.cc
+//	Routines to hand out physical page frames to address spaces, and
+//	the pageout daemon.
+//
+//	The daemon only runs when the faulting thread gives up the CPU:
+//	with the stub file system, disk I/O does not block, so the
+//	daemon needs the timer ("-rs") to get a turn.  Whenever it does
+//	not keep up, the fault handler evicts a page itself.  The same
+//	goes for the prefetch daemon: a page it has not read by the time
+//	it is referenced just faults as usual.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "coremap.h"
+
+//----------------------------------------------------------------------
+// CoreMap::CoreMap
+// 	Initialize the core map; every frame is free.
+//
+//	"frames" is the number of physical page frames
+//	"target" is the number of free frames the pageout daemon keeps
+//		around, or 0 if there is no daemon
+//	"interval" is the page fault frequency threshold, in user ticks,
+//		or 0 to use plain global replacement
+//	"depth" is the number of pages to prefetch when the faults of an
+//		address space follow a stride, or 0 for no prefetching
+//----------------------------------------------------------------------
+
+CoreMap::CoreMap(int frames, int target, int interval, int depth)
+{
+    ASSERT(target >= 0 && target < frames);
+    numFrames = frames;
+    owner = new AddrSpace*[frames];
+    page = new int[frames];
+    isFree = new bool[frames];
+    freedAt = new int[frames];
+    sharers = new FrameSharer*[frames];
+    pinned = new int[frames];
+    prefetched = new bool[frames];
+    for (int i = 0; i < frames; i++) {
+	owner[i] = NULL;
+	page[i] = -1;
+	isFree[i] = TRUE;
+	freedAt[i] = 0;
+	sharers[i] = NULL;
+	pinned[i] = 0;
+	prefetched[i] = FALSE;
+    }
+    numFree = frames;
+    releases = 0;
+    freeTarget = target;
+    pffInterval = interval;
+    suspendedSpaces = new List;
+    mutex = new Semaphore("core map", 1);
+    wakeUp = new Semaphore("pageout", 0);
+    victimPage = -1;
+    prefetchDepth = depth;
+    requests = new PrefetchRequest[PrefetchQueueSize];
+    firstRequest = numRequests = 0;
+    prefetchWork = new Semaphore("prefetch", 0);
+}
+
+//----------------------------------------------------------------------
+// CoreMap::~CoreMap
+// 	De-allocate the core map.
+//----------------------------------------------------------------------
+
+CoreMap::~CoreMap()
+{
+    delete [] owner;
+    delete [] page;
+    delete [] isFree;
+    delete [] freedAt;
+    delete [] sharers;
+    delete [] pinned;
+    delete [] prefetched;
+    delete [] requests;
+    delete mutex;
+    delete wakeUp;
+    delete prefetchWork;
+    delete suspendedSpaces;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Release
+// 	Evict the page held in "frame" (writing it to swap if it is
+//	dirty), and put the frame in the free pool.  The frame remembers
+//	the page, in case its owner wants it back before the frame is
+//	reused; the sharers lose it for good.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Release(int frame)
+{
+    bool dirty;
+
+    ASSERT(!isFree[frame] && owner[frame] != NULL);
+    while (sharers[frame] != NULL)
+	Detach(frame, sharers[frame]->space, TRUE);
+    if (superPageSize > 0 && owner[frame]->SuperPageOf(page[frame]) != -1)
+	stats->numDemotions++;		// the rest stays, page by page
+    dirty = owner[frame]->GetEntry(page[frame])->dirty;
+    if (dirty)
+	stats->numDirtyEvictions++;
+    else
+	stats->numCleanEvictions++;
+    if (faultLog != NULL)
+	faultLog->Evicted(owner[frame], dirty);
+    if (victimPage == -1) {		// the first one for this fault
+	victimPid = owner[frame]->GetPid();
+	victimPage = page[frame];
+	victimDirty = dirty;
+    }
+    owner[frame]->EvictPage(page[frame]);
+    owner[frame]->numResident--;
+    pagePolicy->Freed(frame);
+    isFree[frame] = TRUE;
+    freedAt[frame] = ++releases;
+    numFree++;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::GetFrame
+// 	Take the frame that has been free the longest (so that recently
+//	freed pages have the best chance to be reclaimed).  If there
+//	is no free frame, the replacement policy chooses a page to evict;
+//	with PFF, if "space" is growing, another process is suspended
+//	first, if there is one.
+//
+//	"space" is the address space that needs the frame
+//----------------------------------------------------------------------
+
+int
+CoreMap::GetFrame(AddrSpace *space)
+{
+    int frame = -1, held;
+
+    if (numFree == 0 && (pffInterval == 0 || !space->growing
+			|| !SuspendOther(space))) {
+	if (tlbManager != NULL)		// the use and dirty bits may
+	    tlbManager->SyncBits();	// still be in the TLB
+	held = HoldLastFault(space);
+	Release(SelectVictim(space));
+	if (held != -1 && --pinned[held] == 0)
+	    pagePolicy->Loaded(held, space->GetEntry(page[held]));
+    }
+    for (int i = 0; i < numFrames; i++)
+	if (isFree[i] && (frame == -1 || freedAt[i] < freedAt[frame]))
+	    frame = i;
+    ASSERT(frame != -1);
+    isFree[frame] = FALSE;
+    prefetched[frame] = FALSE;		// it was a bad guess
+    numFree--;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::SelectVictim
+// 	Return the frame the replacement policy would evict to make room
+//	for "space".  With PFF, a process that is not growing has to make
+//	do with the frames it has: the victim is one of its own pages,
+//	if the policy may take any.
+//----------------------------------------------------------------------
+
+int
+CoreMap::SelectVictim(AddrSpace *space)
+{
+    bool *mine, any = FALSE;
+    int victim;
+
+    if (pffInterval == 0 || space->growing)
+	return pagePolicy->SelectVictim();
+    mine = new bool[numFrames];
+    for (int i = 0; i < numFrames; i++) {
+	mine[i] = owner[i] == space && pagePolicy->PageIn(i) != NULL;
+	any = any || mine[i];
+    }
+    if (any)
+	victim = pagePolicy->SelectVictimAmong(mine);
+    else
+	victim = pagePolicy->SelectVictim();
+    delete [] mine;
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::HoldLastFault
+// 	Pin the frame holding the page "space" faulted on last, if it is
+//	still there and something else can be evicted, and return it (or
+//	-1).  The instruction that faulted may be faulting again, on its
+//	other page; were that page the victim, the two could go on
+//	evicting each other, as they do under LFU, where a page that has
+//	just come in has the fewest references of all.
+//----------------------------------------------------------------------
+
+int
+CoreMap::HoldLastFault(AddrSpace *space)
+{
+    TranslationEntry *entry;
+    int frame;
+
+    if (space->lastFaultPage == -1)
+	return -1;
+    entry = space->FindEntry(space->lastFaultPage);
+    if (entry == NULL || !entry->valid)
+	return -1;
+    frame = entry->physicalPage;
+    if (isFree[frame] || owner[frame] != space || pinned[frame] > 0)
+	return -1;
+    pinned[frame]++;
+    pagePolicy->Freed(frame);
+    if (HasVictim())
+	return frame;
+    pinned[frame]--;			// it is all there is
+    pagePolicy->Loaded(frame, entry);
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::HasVictim
+// 	Return TRUE if some frame holds a page that is not pinned, so
+//	that GetFrame can evict it.
+//----------------------------------------------------------------------
+
+bool
+CoreMap::HasVictim()
+{
+    for (int i = 0; i < numFrames; i++)
+	if (!isFree[i] && pinned[i] == 0)
+	    return TRUE;
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::FindFreeRun
+// 	Return the first of "count" free frames in a row, starting at a
+//	multiple of "count", to hold a superpage; or -1 if there is no
+//	such run.  Nothing is evicted to make one.
+//----------------------------------------------------------------------
+
+int
+CoreMap::FindFreeRun(int count)
+{
+    int i;
+
+    for (int first = 0; first + count <= numFrames; first += count) {
+	for (i = first; i < first + count && isFree[i]; i++)
+	    ;
+	if (i == first + count)
+	    return first;
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::TakeFreeFrame
+// 	Take free frame "frame" out of the pool, for page "vpn" of
+//	"space", which has just been loaded into it.
+//----------------------------------------------------------------------
+
+void
+CoreMap::TakeFreeFrame(int frame, AddrSpace *space, int vpn)
+{
+    ASSERT(isFree[frame]);
+    isFree[frame] = FALSE;
+    prefetched[frame] = FALSE;
+    numFree--;
+    if (space->IsSharedText(vpn))	// for the next process to run it
+	space->GetText()->frames[vpn] = frame;
+    owner[frame] = space;
+    page[frame] = vpn;
+    space->numResident++;
+    pagePolicy->Loaded(frame, space->GetEntry(vpn));
+}
+
+//----------------------------------------------------------------------
+// CoreMap::PageFault
+// 	Bring virtual page "vpn" of "space" into memory.  If the frame the
+//	page was last in is free but still holds it, just take it back.
+//	Otherwise read the page, along with the pages after it that can
+//	be read from swap in the same disk request (see
+//	AddrSpace::ReadCluster).
+//
+//	The frames of the cluster are pinned until every page of it is
+//	in, so that none of them, least of all the faulting page, is the
+//	victim chosen to make room for the rest, whatever the policy.
+//	If that would leave nothing to evict, the cluster is cut short.
+//
+//	With superpages, a page of the program that has never been
+//	modified is brought in with the rest of its superpage, if there
+//	is a run of free frames to put it in (see AddrSpace::CanPromote).
+//
+//	The time the fault took, including waiting for the disk or for
+//	memory, goes into the latency histogram and the fault log.
+//----------------------------------------------------------------------
+
+void
+CoreMap::PageFault(AddrSpace *space, int vpn)
+{
+    TranslationEntry *entry = space->GetEntry(vpn);
+    int start = stats->totalTicks;
+    int frame, count, i, zeroFills, ticks;
+    FaultKind kind;
+    int victim, victimVpn;
+    bool dirty;
+
+    mutex->P();
+    while (space->suspended) {		// wait until there is room
+	mutex->V();
+	space->resume->P();
+	mutex->P();
+    }
+    stats->numPageFaults++;
+    victimPage = -1;
+    if (pffInterval > 0) {
+	int now = space->VirtualTime();
+
+	space->growing = now - space->lastFault <= pffInterval;
+	if (!space->growing)
+	    Trim(space);
+	space->lastFault = now;
+    }
+    frame = entry->physicalPage;
+    if (frame >= 0 && frame < numFrames && isFree[frame]
+		&& owner[frame] == space && page[frame] == vpn) {
+	isFree[frame] = FALSE;		// still there: reclaim it
+	numFree--;
+	entry->valid = TRUE;
+	pagePolicy->Loaded(frame, entry);
+	space->numResident++;
+	stats->numReclaims++;
+	if (prefetched[frame])
+	    stats->numPrefetchHits++;
+	prefetched[frame] = FALSE;
+	kind = FaultReclaim;
+	count = 1;
+    } else if ((frame = FindSharedText(space, vpn)) != -1) {
+	AddSharer(frame, space, vpn);	// someone else's copy of our code
+	entry->use = TRUE;
+	stats->numSharedText++;
+	kind = FaultShared;
+	count = 1;
+    } else if (superPageSize > 0 && space->CanPromote(vpn)
+		&& (frame = FindFreeRun(superPageSize)) != -1) {
+	count = superPageSize;		// a whole superpage at once
+	kind = FaultRead;
+	space->LoadSuperPage(vpn, frame);
+	for (i = 0; i < count; i++)
+	    TakeFreeFrame(frame + i, space, vpn - vpn % count + i);
+	entry->use = TRUE;
+	stats->numSuperPages++;
+    } else {
+	count = space->ReadCluster(vpn);
+	kind = FaultRead;
+	for (i = 0; i < count; i++) {
+	    if (i > 0 && numFree == 0 && !HasVictim()) {
+		count = i;		// the rest stays in swap
+		break;
+	    }
+	    frame = GetFrame(space);
+	    zeroFills = stats->numZeroFills;
+	    space->LoadPage(vpn + i, frame);
+	    if (i == 0 && stats->numZeroFills > zeroFills)
+		kind = FaultZero;
+	    if (space->IsSharedText(vpn + i))	// for the next process
+		space->GetText()->frames[vpn + i] = frame;	// to run it
+	    owner[frame] = space;
+	    page[frame] = vpn + i;
+	    space->numResident++;
+	    pinned[frame]++;		// not a victim until all are in
+	}
+	for (i = 0; i < count; i++) {
+	    frame = space->GetEntry(vpn + i)->physicalPage;
+	    if (--pinned[frame] == 0)
+		pagePolicy->Loaded(frame, space->GetEntry(vpn + i));
+	}
+	entry->use = TRUE;
+	if (kind == FaultRead)
+	    stats->numReadFaults++;
+    }
+    if (prefetchDepth > 0)
+	Predict(space, vpn);
+    space->lastFaultPage = vpn;
+    if (numFree < freeTarget)		// running low
+	wakeUp->V();
+    victim = victimPid;			// before someone else faults
+    victimVpn = victimPage;
+    dirty = victimDirty;
+    ticks = stats->totalTicks - start;
+    mutex->V();
+    stats->CountFault(ticks);
+    if (faultLog != NULL)
+	faultLog->Record(space, vpn, kind, count, start, ticks, victim,
+		victimVpn, dirty);
+}
+
+//----------------------------------------------------------------------
+// CoreMap::FreeSpace
+// 	Put every frame of "space" in the free pool, at the head of the
+//	line, as nobody will want its page back.  Nothing is written:
+//	the address space is being destroyed.
+//----------------------------------------------------------------------
+
+void
+CoreMap::FreeSpace(AddrSpace *space)
+{
+    mutex->P();
+    for (int i = 0; i < numFrames; i++) {
+	Detach(i, space, FALSE);
+	if (owner[i] == space && !isFree[i] && sharers[i] != NULL)
+	    Promote(i);			// the frame lives on
+	else if (owner[i] == space) {
+	    if (!isFree[i]) {
+		pagePolicy->Freed(i);
+		isFree[i] = TRUE;
+		numFree++;
+	    }
+	    owner[i] = NULL;
+	    page[i] = -1;
+	    freedAt[i] = 0;
+	}
+    }
+    space->numResident = 0;
+    for (int r = 0; r < numRequests; r++)	// nothing to prefetch
+	if (requests[(firstRequest + r) % PrefetchQueueSize].space == space)
+	    requests[(firstRequest + r) % PrefetchQueueSize].space = NULL;
+    ResumeWaiting();
+    mutex->V();
+}
+
+//----------------------------------------------------------------------
+// CoreMap::FlushPages
+// 	"count" pages of "space", starting at "first", are being removed
+//	from it (a file is being unmapped, or the heap shrinks): evict
+//	the ones in memory, and make sure that no frame in the free pool
+//	can be reclaimed for them afterwards.
+//
+//	"discard" is TRUE if the contents are not wanted any more, FALSE
+//		if the modified pages must be written back
+//----------------------------------------------------------------------
+
+void
+CoreMap::FlushPages(AddrSpace *space, int first, int count, bool discard)
+{
+    TranslationEntry *entry;
+    int frame;
+
+    mutex->P();
+    if (tlbManager != NULL)		// get the latest dirty bits
+	tlbManager->SyncBits();
+    for (int vpn = first; vpn < first + count; vpn++) {
+	entry = space->FindEntry(vpn);
+	if (entry == NULL)		// never used
+	    continue;
+	frame = entry->physicalPage;
+	if (frame < 0 || frame >= numFrames)
+	    continue;
+	if (discard)
+	    entry->dirty = FALSE;
+	if (entry->valid && owner[frame] != space) {
+	    Detach(frame, space, TRUE);	// the owner keeps it
+	    continue;
+	}
+	if (owner[frame] != space || page[frame] != vpn)
+	    continue;
+	if (!isFree[frame] && sharers[frame] != NULL) {
+	    Promote(frame);		// a sharer keeps it
+	    entry->valid = FALSE;
+	    if (tlbManager != NULL)
+		tlbManager->Invalidate(entry);
+	    space->numResident--;
+	    continue;
+	}
+	if (!isFree[frame])
+	    Release(frame);
+	owner[frame] = NULL;
+	page[frame] = -1;
+	freedAt[frame] = 0;
+    }
+    ResumeWaiting();
+    mutex->V();
+}
+
+//----------------------------------------------------------------------
+// CoreMap::ForkSpace
+// 	"child" has just been forked from "parent": map every page the
+//	parent has in memory into the child too, at the same frame, and
+//	make it copy-on-write in both.  Pages of mapped files are not
+//	shared: the child does not inherit the mapping.
+//----------------------------------------------------------------------
+
+void
+CoreMap::ForkSpace(AddrSpace *parent, AddrSpace *child)
+{
+    TranslationEntry *from;
+    int frame;
+
+    mutex->P();
+    if (tlbManager != NULL)		// get the latest dirty bits
+	tlbManager->SyncBits();
+    child->InheritPages(parent);
+    for (int vpn = parent->NextUsedPage(0); vpn != -1;
+				vpn = parent->NextUsedPage(vpn + 1)) {
+	from = parent->GetEntry(vpn);
+	if (from->valid && child->InAddressSpace(vpn)) {
+	    frame = from->physicalPage;
+	    parent->SetCopyOnWrite(vpn, TRUE);
+	    child->SetCopyOnWrite(vpn, TRUE);
+	    AddSharer(frame, child, vpn);
+	    child->GetEntry(vpn)->dirty = from->dirty;	// the frame is
+					// newer than what is in swap
+	    stats->numSharedPages++;
+	}
+    }
+    mutex->V();
+}
+
+//----------------------------------------------------------------------
+// CoreMap::CopyOnWrite
+// 	"space" wrote to virtual page "vpn", which it maps read-only
+//	because the frame was shared after a Fork.  If the frame is still
+//	shared, copy it to a frame of our own; then make the page
+//	writable.
+//
+//	The page may have been evicted before we got here; then it will
+//	just fault again.
+//----------------------------------------------------------------------
+
+void
+CoreMap::CopyOnWrite(AddrSpace *space, int vpn)
+{
+    TranslationEntry *entry = space->GetEntry(vpn);
+    int frame, copy;
+    char *contents;
+
+    mutex->P();
+    if (!entry->valid || !space->IsCopyOnWrite(vpn)) {
+	mutex->V();
+	return;
+    }
+    frame = entry->physicalPage;
+    if (owner[frame] != space || sharers[frame] != NULL) {
+	contents = new char[PageSize];	// the frame may be chosen to
+	bcopy(&(machine->mainMemory[frame * PageSize]), contents,
+			PageSize);	// make room for the copy
+	if (owner[frame] == space)
+	    Promote(frame);
+	else
+	    Detach(frame, space, FALSE);
+	if (tlbManager != NULL)
+	    tlbManager->Invalidate(entry);
+	entry->valid = FALSE;
+	space->numResident--;
+
+	copy = GetFrame(space);
+	bcopy(contents, &(machine->mainMemory[copy * PageSize]), PageSize);
+	delete [] contents;
+	entry->physicalPage = copy;
+	entry->valid = TRUE;
+	owner[copy] = space;
+	page[copy] = vpn;
+	pagePolicy->Loaded(copy, entry);
+	space->numResident++;
+	stats->numCopiesOnWrite++;
+    }
+    space->SetCopyOnWrite(vpn, FALSE);
+    mutex->V();
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Pin
+// 	The kernel is about to move data to or from virtual page "vpn" of
+//	"space", on its own: bring the page into memory (copying it, if
+//	it is copy-on-write and we are writing), set its use and dirty
+//	bits as the hardware would, and keep it in its frame until Unpin.
+//
+//	Return the frame, or -1 if there is no such page, or if it is a
+//	page of code and we are writing.
+//----------------------------------------------------------------------
+
+int
+CoreMap::Pin(AddrSpace *space, int vpn, bool writing)
+{
+    TranslationEntry *entry = space->GetEntry(vpn);
+    int frame;
+
+    if (!space->InAddressSpace(vpn)
+		|| (writing && entry->readOnly && !space->IsCopyOnWrite(vpn)))
+	return -1;
+    for (;;) {
+	if (!entry->valid)
+	    PageFault(space, vpn);
+	if (writing && space->IsCopyOnWrite(vpn))
+	    CopyOnWrite(space, vpn);
+	mutex->P();
+	if (entry->valid && !(writing && entry->readOnly))
+	    break;
+	mutex->V();			// taken away again meanwhile
+    }
+    frame = entry->physicalPage;
+    if (pinned[frame]++ == 0)
+	pagePolicy->Freed(frame);	// no longer a candidate victim
+    entry->use = TRUE;
+    if (writing)
+	entry->dirty = TRUE;
+    mutex->V();
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Unpin
+// 	The kernel is done with "frame"; it can be evicted again.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Unpin(int frame)
+{
+    mutex->P();
+    ASSERT(pinned[frame] > 0);
+    if (--pinned[frame] == 0)
+	pagePolicy->Loaded(frame, owner[frame]->GetEntry(page[frame]));
+    mutex->V();
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Detach
+// 	Take "frame" away from "space", if it is one of its sharers.
+//
+//	"evict" is TRUE if the page must be evicted from "space" (and
+//		written to its swap slot if it is dirty), FALSE if the
+//		address space is going away anyway
+//----------------------------------------------------------------------
+
+void
+CoreMap::Detach(int frame, AddrSpace *space, bool evict)
+{
+    FrameSharer **p = &sharers[frame], *s;
+
+    while (*p != NULL)
+	if ((*p)->space == space) {
+	    s = *p;
+	    *p = s->next;
+	    if (evict) {
+		space->EvictPage(s->vpn);
+		space->numResident--;
+	    }
+	    delete s;
+	} else
+	    p = &(*p)->next;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::AddSharer
+// 	Map "frame", which has an owner already, at virtual page "vpn" of
+//	"space" too.
+//----------------------------------------------------------------------
+
+void
+CoreMap::AddSharer(int frame, AddrSpace *space, int vpn)
+{
+    TranslationEntry *entry = space->GetEntry(vpn);
+    FrameSharer *s = new FrameSharer;
+
+    s->space = space;
+    s->vpn = vpn;
+    s->next = sharers[frame];
+    sharers[frame] = s;
+    entry->physicalPage = frame;
+    entry->use = entry->dirty = FALSE;
+    entry->valid = TRUE;
+    space->numResident++;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::FindSharedText
+// 	If virtual page "vpn" of "space" is all code, and another address
+//	space running the same program has it in memory, return its
+//	frame.  The text cache remembers the last frame each code page
+//	was loaded into; it still holds the page if its owner is running
+//	the same program and has that page there.
+//
+//	Return -1 if the page has to be read.
+//----------------------------------------------------------------------
+
+int
+CoreMap::FindSharedText(AddrSpace *space, int vpn)
+{
+    int frame;
+
+    if (!space->IsSharedText(vpn))
+	return -1;
+    frame = space->GetText()->frames[vpn];
+    if (frame == -1 || isFree[frame] || owner[frame] == NULL
+		|| owner[frame]->GetText() != space->GetText()
+		|| page[frame] != vpn)
+	return -1;
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Promote
+// 	The owner of "frame" is letting go of it: make its first sharer
+//	the owner.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Promote(int frame)
+{
+    FrameSharer *s = sharers[frame];
+
+    owner[frame] = s->space;
+    page[frame] = s->vpn;
+    sharers[frame] = s->next;
+    delete s;
+    if (pinned[frame] == 0)		// otherwise Unpin will do it
+	pagePolicy->Loaded(frame,
+			owner[frame]->GetEntry(page[frame]));
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Trim
+// 	"space" has gone a long time without a page fault, so its working
+//	set has shrunk: release every page it has not used since its
+//	last fault, and start over with the use bits of the others.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Trim(AddrSpace *space)
+{
+    TranslationEntry *entry;
+
+    if (tlbManager != NULL)
+	tlbManager->SyncBits();
+    for (int i = 0; i < numFrames; i++)
+	if (!isFree[i] && owner[i] == space && sharers[i] == NULL
+		&& pinned[i] == 0) {
+	    entry = space->GetEntry(page[i]);
+	    if (!entry->use) {
+		Release(i);
+		stats->numTrimmed++;
+	    } else {
+		if (tlbManager != NULL)	// or the TLB would set it again
+		    tlbManager->Invalidate(entry);
+		entry->use = FALSE;
+	    }
+	}
+    ResumeWaiting();
+}
+
+//----------------------------------------------------------------------
+// CoreMap::SuspendOther
+// 	Memory is overcommitted: swap out the process with the most
+//	frames, other than "space", and put it on the list of processes
+//	waiting for memory.  Its thread blocks on its next page fault,
+//	which comes right away, as it has no page left in memory.
+//
+//	Return FALSE if "space" is the only process in memory.
+//----------------------------------------------------------------------
+
+bool
+CoreMap::SuspendOther(AddrSpace *space)
+{
+    AddrSpace *victim = NULL;
+    int i;
+
+    for (i = 0; i < numFrames; i++)
+	if (!isFree[i] && owner[i] != space && (victim == NULL
+			|| owner[i]->numResident > victim->numResident))
+	    victim = owner[i];
+    if (victim == NULL)
+	return FALSE;
+
+    DEBUG('a', "Suspending an address space with %d frames\n",
+		victim->numResident);
+    if (tlbManager != NULL)
+	tlbManager->SyncBits();
+    victim->wanted = victim->numResident;
+    victim->suspended = TRUE;
+    for (i = 0; i < numFrames; i++) {
+	if (pinned[i] > 0)		// it will fault as soon as the
+	    continue;			// kernel is done with it
+	Detach(i, victim, TRUE);
+	if (!isFree[i] && owner[i] == victim)
+	    Release(i);
+    }
+    suspendedSpaces->Append((void *) victim);
+    stats->numSuspends++;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::ResumeWaiting
+// 	Let suspended processes run again, oldest first, as long as
+//	there are enough free frames for the pages each had when it was
+//	suspended.
+//----------------------------------------------------------------------
+
+void
+CoreMap::ResumeWaiting()
+{
+    AddrSpace *space;
+    int room = numFree;
+
+    while (!suspendedSpaces->IsEmpty()) {
+	space = (AddrSpace *) suspendedSpaces->Remove();
+	if (room < space->wanted) {
+	    suspendedSpaces->Prepend((void *) space);
+	    return;
+	}
+	DEBUG('a', "Resuming an address space, %d frames free\n", room);
+	room -= space->wanted;
+	space->suspended = FALSE;
+	space->resume->V();
+    }
+}
+
+//----------------------------------------------------------------------
+// CoreMap::PageOut
+// 	The pageout daemon.  Each time it is woken up, evict pages chosen
+//	by the replacement policy until "freeTarget" frames are free.
+//	Never returns.
+//----------------------------------------------------------------------
+
+void
+CoreMap::PageOut()
+{
+    int frame;
+
+    for (;;) {
+	wakeUp->P();
+	mutex->P();
+	while (numFree < freeTarget) {
+	    if (tlbManager != NULL)
+		tlbManager->SyncBits();
+	    frame = pagePolicy->SelectVictim();
+	    if (owner[frame]->GetEntry(page[frame])->dirty)
+		stats->numPageOuts++;
+	    Release(frame);
+	}
+	mutex->V();
+    }
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Predict
+// 	Virtual page "vpn" of "space" just faulted.  If it is the same
+//	distance from the previous fault as that one was from the fault
+//	before, expect the next faults along the same stride, and queue
+//	those pages for the prefetch daemon.  A request that does not
+//	fit in the queue is dropped.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Predict(AddrSpace *space, int vpn)
+{
+    int stride = vpn - space->lastFaultPage;
+
+    if (space->lastFaultPage != -1 && stride != 0
+		&& stride == space->faultStride)
+	space->strideRun++;
+    else {
+	space->faultStride = stride;
+	space->strideRun = 0;
+    }
+    if (space->strideRun == 0)
+	return;
+    for (int i = 1; i <= prefetchDepth; i++) {
+	if (!space->IsOnDisk(vpn + i * stride))
+	    continue;
+	if (numRequests == PrefetchQueueSize)
+	    break;
+	requests[(firstRequest + numRequests) % PrefetchQueueSize].space
+		= space;
+	requests[(firstRequest + numRequests) % PrefetchQueueSize].vpn
+		= vpn + i * stride;
+	numRequests++;
+	prefetchWork->V();
+    }
+}
+
+//----------------------------------------------------------------------
+// CoreMap::ReadAhead
+// 	Read virtual page "vpn" of "space" into the free frame that has
+//	been in the pool the longest, and put the frame back at the end
+//	of the pool, with the page in it, so that a fault on the page
+//	reclaims it.  Nothing is done if the page was brought in
+//	meanwhile, or if no frame is free: a prefetch never evicts.
+//----------------------------------------------------------------------
+
+void
+CoreMap::ReadAhead(AddrSpace *space, int vpn)
+{
+    TranslationEntry *entry;
+    int frame;
+
+    if (numFree == 0 || space->suspended || !space->IsOnDisk(vpn))
+	return;
+    entry = space->GetEntry(vpn);
+    frame = entry->physicalPage;
+    if (frame >= 0 && frame < numFrames && isFree[frame]
+		&& owner[frame] == space && page[frame] == vpn)
+	return;				// already in the pool
+    frame = GetFrame(space);
+    space->LoadPage(vpn, frame);
+    entry->valid = FALSE;		// until it is reclaimed
+    owner[frame] = space;
+    page[frame] = vpn;
+    isFree[frame] = TRUE;
+    freedAt[frame] = ++releases;
+    prefetched[frame] = TRUE;
+    numFree++;
+    stats->numPrefetched++;
+}
+
+//----------------------------------------------------------------------
+// CoreMap::Prefetch
+// 	Body of the prefetch daemon: read ahead the pages queued by
+//	Predict, one at a time.
+//----------------------------------------------------------------------
+
+void
+CoreMap::Prefetch()
+{
+    PrefetchRequest request;
+
+    for (;;) {
+	prefetchWork->P();
+	mutex->P();
+	if (numRequests > 0) {
+	    request = requests[firstRequest];
+	    firstRequest = (firstRequest + 1) % PrefetchQueueSize;
+	    numRequests--;
+	    if (request.space != NULL)
+		ReadAhead(request.space, request.vpn);
+	}
+	mutex->V();
+    }
+}
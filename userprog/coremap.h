@@ -0,0 +1,177 @@
+// coremap.h
+//	Data structures to manage physical memory for demand paging.
+//
+//	The core map records, for every physical page frame, which
+//	virtual page of which address space it holds.  Page faults are
+//	served from a pool of free frames; when the pool is empty, the
+//	replacement policy picks a victim and it is evicted on the spot.
+//	Replacement is global: the victim may belong to any address
+//	space, and is written to that space's swap file.
+//
+//	Optionally ("-pageout"), a pageout daemon thread keeps the pool
+//	filled ahead of time, evicting pages (and writing the dirty ones
+//	to swap) whenever it gets to run, so that most faults only have
+//	to read.  A freed frame keeps its contents until it is reused, so
+//	a fault on a page still sitting in the pool just takes the frame
+//	back, without any I/O.
+//
+//	After a Fork, a frame may also be mapped, read-only, by other
+//	address spaces than its owner: its "sharers".  Evicting the page
+//	takes it away from all of them.  The first one to write to it
+//	gets a copy of its own (copy-on-write); when the owner goes
+//	away, a sharer becomes the owner.  Pages of code are shared the
+//	same way among all the processes running a program, whether they
+//	were forked or not.
+//
+//	A frame the kernel is moving system call data to or from is
+//	pinned: it is hidden from the replacement policy, so that its
+//	page stays put even if the kernel blocks.
+//
+//	Optionally ("-pff"), frames are allocated by page fault frequency:
+//	a process that faults again within "pffInterval" ticks of its own
+//	virtual time is short of memory, and simply gets another frame;
+//	one that has gone longer without a fault loses every page it
+//	has not used since its previous fault, and if no frame is free
+//	even so, replaces one of its own pages.  If a process needs to
+//	grow and no frame is free, memory is overcommitted: rather than
+//	let every process thrash, the one with the largest resident set
+//	is suspended, all its pages written out, until there is room
+//	for it again.
+//
+//	Optionally ("-super"), pages of the program are brought in by
+//	superpages: aligned groups of pages, which go into a run of as
+//	many free frames, so that a single TLB entry can map them all.
+//	Evicting any page of a superpage demotes it: the rest of it
+//	stays in memory, mapped page by page.
+//
+//	Optionally ("-prefetch"), the faults of each address space are
+//	watched for a constant stride (say, every page, or every fourth
+//	page, going up or down): after two faults the same distance
+//	apart, the next few pages along that stride are queued for a
+//	prefetch daemon thread.  It reads them into free frames, but
+//	leaves them in the pool, as if they had just been evicted: if
+//	the guess was right, the fault on the page takes its frame back
+//	without I/O; if not, the frame is simply reused.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef COREMAP_H
+#define COREMAP_H
+
+#include "copyright.h"
+#include "synch.h"
+#include "list.h"
+
+class AddrSpace;
+
+// Another address space mapping a frame, copy-on-write
+class FrameSharer {
+  public:
+    AddrSpace *space;
+    int vpn;				// the page it maps the frame at
+    FrameSharer *next;
+};
+
+// A page the prefetch daemon is asked to read
+class PrefetchRequest {
+  public:
+    AddrSpace *space;			// NULL if it went away meanwhile
+    int vpn;
+};
+
+#define PrefetchQueueSize	32	// requests waiting for the daemon
+
+class CoreMap {
+  public:
+    CoreMap(int frames, int target, int interval, int depth);
+					// all "frames" start out free; the
+					// daemon keeps "target" frames free
+					// (0 means no daemon); "interval" is
+					// the PFF threshold (0 means none);
+					// "depth" pages are prefetched along
+					// a stride (0 means none)
+    ~CoreMap();
+
+    void PageFault(AddrSpace *space, int vpn);
+					// bring page "vpn" of "space" into
+					// memory
+    void FreeSpace(AddrSpace *space);	// "space" is going away: free
+					// its frames
+    void FlushPages(AddrSpace *space, int first, int count, bool discard);
+					// write back (or not) and free these
+					// pages of "space", for good
+    void ForkSpace(AddrSpace *parent, AddrSpace *child);
+					// share the pages of "parent" with
+					// its new "child"
+    void CopyOnWrite(AddrSpace *space, int vpn);
+					// "space" wrote to shared page "vpn"
+    int Pin(AddrSpace *space, int vpn, bool writing);
+					// bring "vpn" in, and keep it in its
+					// frame until Unpin
+    void Unpin(int frame);
+    void PageOut();			// body of the pageout daemon
+    void Prefetch();			// body of the prefetch daemon
+
+  private:
+    int GetFrame(AddrSpace *space);	// take a free frame for "space",
+					// evicting a page if there is none
+    int HoldLastFault(AddrSpace *space);
+					// keep the page of the last fault
+					// of "space" from being evicted
+    int SelectVictim(AddrSpace *space);	// the page to evict to make room
+					// for "space"
+    bool HasVictim();			// is there a page GetFrame can
+					// evict?
+    int FindFreeRun(int count);		// aligned free frames for a
+					// superpage, or -1
+    void TakeFreeFrame(int frame, AddrSpace *space, int vpn);
+					// give "frame" to a superpage
+    void Release(int frame);		// evict the page in "frame"
+    void Detach(int frame, AddrSpace *space, bool evict);
+					// "space" no longer shares "frame"
+    void Promote(int frame);		// a sharer becomes the owner
+    void AddSharer(int frame, AddrSpace *space, int vpn);
+					// map "frame" at "vpn" in "space"
+    int FindSharedText(AddrSpace *space, int vpn);
+					// frame already holding this page
+					// of its code, or -1
+    void Trim(AddrSpace *space);	// PFF: release its unused pages
+    bool SuspendOther(AddrSpace *space);	// PFF: swap out some
+					// process other than "space"
+    void ResumeWaiting();		// let suspended processes back in,
+					// if there is room
+    void Predict(AddrSpace *space, int vpn);
+					// queue the pages likely to fault
+					// after "vpn"
+    void ReadAhead(AddrSpace *space, int vpn);
+					// prefetch one page into the pool
+
+    int numFrames;
+    AddrSpace **owner;			// address space of each frame's page
+    int *page;				// virtual page in each frame
+    FrameSharer **sharers;		// others mapping each frame
+    int *pinned;			// kernel I/O in progress to each
+    bool *isFree;			// in the pool of free frames?
+    int *freedAt;			// when it went into the pool
+    bool *prefetched;			// read ahead, and not used yet?
+    int numFree;			// frames in the pool
+    int releases;			// number of calls to Release
+    int freeTarget;			// what the daemon aims for
+    int pffInterval;			// longest fault interval at which a
+					// process still grows
+    List *suspendedSpaces;		// waiting for memory, oldest first
+    Semaphore *mutex;			// one of the daemon and the page
+					// fault handler at a time
+    Semaphore *wakeUp;			// daemon waits here for work
+    int prefetchDepth;			// pages queued per prediction
+    PrefetchRequest *requests;		// circular queue for the prefetch
+    int firstRequest, numRequests;	// daemon
+    Semaphore *prefetchWork;		// where it waits for requests
+    int victimPid;			// first page evicted by the fault
+    int victimPage;			// being served, for the fault log;
+    bool victimDirty;			// victimPage is -1 if none
+};
+
+#endif // COREMAP_H
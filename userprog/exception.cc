@@ -4,8 +4,7 @@
 //	transfer back to here from user code:
 //
 //	syscall -- The user code explicitly requests to call a procedure
-//	in the Nachos kernel.  Right now, the only function we support is
-//	"Halt".
+//	in the Nachos kernel.
 //
 //	exceptions -- The user code does something that the CPU can't handle.
 //	For instance, accessing memory that doesn't exist, arithmetic errors,
@@ -14,8 +13,9 @@
 //	Interrupts (which can also cause control to transfer from user
 //	code into the Nachos kernel) are handled elsewhere.
 //
-// For now, this only handles the Halt() system call.
-// Everything else core dumps.
+// The buffers of Read and Write are moved a page at a time, straight
+// between the file (or the console) and the user's pinned frames; see
+// usermem.h.
 //
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
@@ -24,49 +24,217 @@
 #include "copyright.h"
 #include "system.h"
 #include "syscall.h"
+#include "usermem.h"
+#include "checkpoint.h"
 
+//----------------------------------------------------------------------
+// AdvancePC
+// 	Move the user program counter past the system call, so that it
+//	is not executed again when we return.
+//----------------------------------------------------------------------
 
-int fifo(TranslationEntry *pt, int vpn)
+static void
+AdvancePC()
 {
-    int marcoVictima, aux;
+    int pc = machine->ReadRegister(NextPCReg);
+
+    machine->WriteRegister(PrevPCReg, machine->ReadRegister(PCReg));
+    machine->WriteRegister(PCReg, pc);
+    machine->WriteRegister(NextPCReg, pc + 4);
+}
+
+//----------------------------------------------------------------------
+// RefillTLB
+// 	Load the translation of virtual page "vpn" of "space", which is
+//	in memory, into the TLB: the whole superpage, if it is part of
+//	one (an inverted page table only maps single pages).
+//----------------------------------------------------------------------
+
+static void
+RefillTLB(AddrSpace *space, int vpn)
+{
+    int base = space->SuperPageOf(vpn);
+
+    if (base != -1 && !invertedTable)
+	tlbManager->Refill(space->GetEntry(base), space->GetASID(),
+			superPageSize);
+    else
+	tlbManager->Refill(space->GetEntry(vpn), space->GetASID(), 1);
+}
+
+//----------------------------------------------------------------------
+// ExitProcess
+// 	End the current process with exit status "status": give its
+//	memory back, tell anyone joining it, and finish its thread.
+//----------------------------------------------------------------------
 
-    pt[vpn].physicalPage = stats->numPageFaults % NumPhysPages;//indicamos en numero de marco a la pagina
-    aux = stats->numPageFaults % NumPhysPages;
-    marcoVictima = marcosVictima[aux];//elegimos el marco victima        
-    marcosVictima[aux] = vpn;
+static void
+ExitProcess(int status)
+{
+    int id = currentThread->space->GetPid();
 
-    return marcoVictima;
+    delete currentThread->space;	// gives its frames and swap back
+    currentThread->space = NULL;
+    processTable->Exit(id, status);
+    currentThread->Finish();
 }
 
-int reloj(TranslationEntry *pt, int vpn)
+//----------------------------------------------------------------------
+// ForkedProcess
+// 	Body of the thread of a process created by Fork: pick up the
+//	registers the parent left us, and jump to user code.
+//----------------------------------------------------------------------
+
+static void
+ForkedProcess(int dummy)
 {
-	int *marcoVictima = (int*)(lista->Remove());
-	
-	while(pt[*marcoVictima].use == TRUE)
-	{
-		pt[*marcoVictima].use = FALSE;
-		lista->Append(marcoVictima);
-		marcoVictima = (int*) (lista->Remove());
-	}
-	
-	
-	pt[vpn].physicalPage = pt[*marcoVictima].physicalPage;
-	return *marcoVictima;
+    currentThread->RestoreUserState();
+    currentThread->space->RestoreState();
+    machine->Run();
+    ASSERT(FALSE);
+}
+
+//----------------------------------------------------------------------
+// ExecProcess
+// 	Body of the thread of a process created by Exec: set up the
+//	initial registers, and jump to the start of the program.
+//
+//	"id" is the SpaceId of the process
+//----------------------------------------------------------------------
+
+static void
+ExecProcess(int id)
+{
+    currentThread->space->InitRegisters();
+    currentThread->space->RestoreState();
+    processTable->Started(id);
+    machine->Run();
+    ASSERT(FALSE);
+}
+
+//----------------------------------------------------------------------
+// ExecProgram
+// 	Do the work of the Exec system call: load the program named at
+//	user address "nameAddr" into a new address space, and fork a
+//	thread to run it.  Return its SpaceId, or -1 if the program
+//	cannot be opened, is not a NOFF program that fits in an address
+//	space, or the process table is full.
+//
+//	The address space is demand paged, so only the header of the
+//	program is read here; its code is shared with other processes
+//	running it, if any.
+//----------------------------------------------------------------------
+
+static SpaceId
+ExecProgram(int nameAddr)
+{
+    int since = stats->totalTicks;
+    char name[UserStringMax];
+    OpenFile *executable = NULL;
+    AddrSpace *space;
+    Thread *t;
+    SpaceId id;
+
+    if (ReadUserString(nameAddr, name, UserStringMax))
+	executable = fileSystem->Open(name);
+    if (executable == NULL)
+	return -1;
+    if (!IsExecutable(executable)) {
+	delete executable;
+	return -1;
+    }
+    space = new AddrSpace(executable, name);	// it closes the file
+    id = processTable->Add(space, currentThread->space->GetPid(), since);
+    if (id == -1) {
+	delete space;
+	return -1;
+    }
+    if (profiler != NULL)
+	profiler->LoadSymbols(name);
+    t = new Thread("exec");
+    t->space = space;
+    t->Fork(ExecProcess, id);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// ReadFromFile, WriteToFile
+// 	Chunk functions for UserTransfer: move part of a user buffer
+//	to or from an open file.
+//
+//	"arg" is the OpenFile
+//----------------------------------------------------------------------
+
+static int
+ReadFromFile(char *chunk, int count, int arg)
+{
+    return ((OpenFile *) arg)->Read(chunk, count);
 }
 
-int LRU(TranslationEntry *pt, int vpn)
+static int
+WriteToFile(char *chunk, int count, int arg)
 {
-    int* victima, *Paux;
-    *victima = 0;
-    
-    victima = (int *)(lista->Remove());	
-	
-    pt[*victima].valid = FALSE;
-    pt[vpn].physicalPage = pt[*victima].physicalPage;
-    return *victima;					
+    return ((OpenFile *) arg)->Write(chunk, count);
 }
 
+//----------------------------------------------------------------------
+// ReadFromConsole, WriteToConsole
+// 	Chunk functions for UserTransfer: move part of a user buffer
+//	to or from the console.  A read ends with the first newline.
+//
+//	"arg" points to the flag ReadFromConsole sets at the newline
+//----------------------------------------------------------------------
+
+static int
+ReadFromConsole(char *chunk, int count, int arg)
+{
+    bool *ended = (bool *) arg;
+    int i;
+
+    for (i = 0; i < count && !*ended; i++) {
+	chunk[i] = synchConsole->GetChar();
+	*ended = (chunk[i] == '\n');
+    }
+    return i;
+}
+
+static int
+WriteToConsole(char *chunk, int count, int dummy)
+{
+    for (int i = 0; i < count; i++)
+	synchConsole->PutChar(chunk[i]);
+    return count;
+}
 
+//----------------------------------------------------------------------
+// Transfer
+// 	Do the work of the Read and Write system calls: move "size" bytes
+//	of the user buffer at "addr" from or to the file "id".  Return
+//	the number of bytes moved, or -1 if "id" or the buffer is bad.
+//----------------------------------------------------------------------
+
+static int
+Transfer(int addr, int size, OpenFileId id, bool reading)
+{
+    OpenFile *file;
+    bool ended = FALSE;
+
+    if (id == ConsoleInput || id == ConsoleOutput) {
+	if (reading != (id == ConsoleInput))
+	    return -1;
+	if (synchConsole == NULL)	// only now: it polls the keyboard
+	    synchConsole = new SynchConsole(NULL, NULL);
+	if (!reading)
+	    return UserTransfer(addr, size, FALSE, WriteToConsole, 0);
+	return UserTransfer(addr, size, TRUE, ReadFromConsole, (int) &ended);
+    }
+    file = currentThread->space->GetFile(id);
+    if (file == NULL)
+	return -1;
+    if (reading)
+	return UserTransfer(addr, size, TRUE, ReadFromFile, (int) file);
+    return UserTransfer(addr, size, FALSE, WriteToFile, (int) file);
+}
 
 //----------------------------------------------------------------------
 // ExceptionHandler
@@ -95,60 +263,159 @@ void
 ExceptionHandler(ExceptionType which)
 {
     int type = machine->ReadRegister(2);
-    int marcoVictima,*vpn = new int;
 
     if ((which == SyscallException) && (type == SC_Halt)) {
 	DEBUG('a', "Shutdown, initiated by user program.\n");
    	interrupt->Halt();
     } 
-    else if((which == PageFaultException)==TRUE)
+    else if ((which == SyscallException) && (type == SC_Exit)) {
+	DEBUG('a', "User program exited with status %d.\n",
+		machine->ReadRegister(4));
+	ExitProcess(machine->ReadRegister(4));
+    }
+    else if ((which == SyscallException) && (type == SC_Exec)) {
+	machine->WriteRegister(2, ExecProgram(machine->ReadRegister(4)));
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Join)) {
+	machine->WriteRegister(2, processTable->Join(machine->ReadRegister(4),
+				currentThread->space->GetPid()));
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Fork)) {
+	int func = machine->ReadRegister(4);
+	Thread *child = new Thread("forked");
+	int pc, nextPC;
+
+	DEBUG('a', "Fork, child starts at 0x%x.\n", func);
+	child->space = new AddrSpace(currentThread->space);
+	processTable->Add(child->space, currentThread->space->GetPid(),
+			stats->totalTicks);
+	AdvancePC();
+	pc = machine->ReadRegister(PCReg);
+	nextPC = machine->ReadRegister(NextPCReg);
+	machine->WriteRegister(PCReg, func);	// the child gets our
+	machine->WriteRegister(NextPCReg, func + 4);	// registers, but
+	child->SaveUserState();			// starts at "func"
+	machine->WriteRegister(PCReg, pc);
+	machine->WriteRegister(NextPCReg, nextPC);
+	child->Fork(ForkedProcess, 0);
+    }
+    else if ((which == SyscallException) && (type == SC_Create)) {
+	char name[UserStringMax];
+
+	if (ReadUserString(machine->ReadRegister(4), name, UserStringMax)
+		&& fileSystem->Create(name, 0))
+	    DEBUG('a', "Created file %s.\n", name);
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Open)) {
+	char name[UserStringMax];
+	OpenFile *file = NULL;
+	int id = -1;
+
+	if (ReadUserString(machine->ReadRegister(4), name, UserStringMax))
+	    file = fileSystem->Open(name);
+	if (file != NULL) {
+	    id = currentThread->space->AddFile(file);
+	    if (id == -1)
+		delete file;		// too many open files
+	}
+	DEBUG('a', "Open returns %d.\n", id);
+	machine->WriteRegister(2, id);
+	AdvancePC();
+    }
+    else if ((which == SyscallException) &&
+		(type == SC_Read || type == SC_Write)) {
+	int done = Transfer(machine->ReadRegister(4),
+			    machine->ReadRegister(5),
+			    machine->ReadRegister(6), type == SC_Read);
+
+	machine->WriteRegister(2, done);
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Close)) {
+	currentThread->space->CloseFile(machine->ReadRegister(4));
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Map)) {
+	char name[UserStringMax];
+	OpenFile *file = NULL;
+	int addr = 0;
+
+	if (ReadUserString(machine->ReadRegister(4), name, UserStringMax))
+	    file = fileSystem->Open(name);
+	if (file != NULL) {
+	    addr = currentThread->space->Map(file);
+	    if (addr == 0)
+		delete file;		// no room for it
+	}
+	machine->WriteRegister(2, addr);
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Unmap)) {
+	currentThread->space->Unmap(machine->ReadRegister(4));
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Sbrk)) {
+	machine->WriteRegister(2,
+		currentThread->space->Sbrk(machine->ReadRegister(4)));
+	AdvancePC();
+    }
+    else if ((which == SyscallException) && (type == SC_Checkpoint)) {
+	char name[UserStringMax];
+	int registers[NumTotalRegs];
+	int result = -1;
+
+	AdvancePC();			// resume after the system call,
+	for (int i = 0; i < NumTotalRegs; i++)
+	    registers[i] = machine->ReadRegister(i);
+	registers[2] = 1;		// which returns 1 there
+	if (ReadUserString(machine->ReadRegister(4), name, UserStringMax)
+		&& TakeCheckpoint(name, currentThread->space, registers))
+	    result = 0;
+	machine->WriteRegister(2, result);
+    }
+    else if (which == PageFaultException)
     {
-	if(stats->numPageFaults<NumPhysPages)//si existen marcos libres
-        {
-            //indica el numero de marco a la pagina
-            machine->pageTable[machine->vpn].physicalPage = 	stats->
-						numPageFaults;            
-            marcoVictima = stats->numPageFaults;
-            marcosVictima[stats->numPageFaults] = machine->vpn;
-        }   
-        else
-        {
-	    switch(numAlgoritmo)
-            {                
-                case 1://FIFO
-                    marcoVictima = fifo(machine->pageTable,machine->vpn);
-                    break;
-                case 2:
-                    marcoVictima = reloj(machine->pageTable,machine->vpn);
-                break;
-		case 3:
-		    marcoVictima = LRU(machine->pageTable,machine->vpn);
-		break;
-            }
-        }
-	*vpn = machine->vpn;
-        stats->numPageFaults++;//incrementamos el numero de fallos pagina
-        machine->pageTable[marcoVictima].valid = false;//indicamos que no esta en memoria el marco victima
-        if(machine->pageTable[marcoVictima].dirty)//si se modifico el marco guardar en el archivo swp
-        {
-	    stats->numDiskWrites++;
-            archivo->WriteAt(&(machine->mainMemory[machine->pageTable[marcoVictima].physicalPage*PageSize]),PageSize,
-                        machine->pageTable[marcoVictima].virtualPage*PageSize);
-            machine->pageTable[marcoVictima].dirty = false;//indicar que ya se guardo y no se ha modificado
-        }
-        lista->Append(vpn);
-        bzero(&(machine->mainMemory[machine->pageTable[machine->vpn].physicalPage*PageSize]),PageSize);
-  
-       archivo->ReadAt(&(machine->mainMemory[machine->pageTable[machine->vpn].physicalPage*PageSize]),PageSize,
-               machine->pageTable[machine->vpn].virtualPage*PageSize);
-        stats->numDiskReads++;
-        machine->pageTable[machine->vpn].valid = true;
-	//printf("vpn:%d reads:%d\n",*vpn,stats->numDiskReads++);
+	AddrSpace *space = currentThread->space;
+	unsigned int vpn = 
+		(unsigned) machine->ReadRegister(BadVAddrReg) / PageSize;
+
+	// with a TLB, the page table has not been checked by the
+	// hardware, so the fault may be for an address outside the
+	// address space; and nothing checks the pages for mapped files.
+	// Only the process at fault is killed, not Nachos.
+	if (!space->InAddressSpace(vpn)) {
+	    printf("Address error: virtual page %d is outside the "
+			"address space\n", vpn);
+	    ExitProcess(-1);
+	}
+	if (!space->GetEntry(vpn)->valid)	// not in memory
+	    coreMap->PageFault(space, vpn);
+	// only a TLB miss, or the page was just loaded; but the pageout
+	// daemon may have run meanwhile and taken it away again, in which
+	// case the instruction will just fault once more
+	if (tlbManager != NULL && space->GetEntry(vpn)->valid)
+	    RefillTLB(space, vpn);
+    }
+    else if (which == ReadOnlyException)
+    {
+	AddrSpace *space = currentThread->space;
+	unsigned int vpn = 
+		(unsigned) machine->ReadRegister(BadVAddrReg) / PageSize;
+
+	if (!space->IsCopyOnWrite(vpn)) {	// a real write to code
+	    printf("Write to read-only virtual page %d\n", vpn);
+	    ExitProcess(-1);
+	}
+	coreMap->CopyOnWrite(space, vpn);	// the write is retried
+	if (tlbManager != NULL && space->GetEntry(vpn)->valid)
+	    RefillTLB(space, vpn);
     }
     else
     {
 	printf("Unexpected user mode exception %d %d\n", which, type);
 	ASSERT(FALSE);
     }
-    //lista->imprimeLista();
 }
@@ -0,0 +1,161 @@
+// faultlog.cc
+//	Routines to record page faults in a CSV file, and count them per
+//	process.  See faultlog.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "faultlog.h"
+
+static char *kindNames[] = { "reclaim", "shared", "zero", "read" };
+
+//----------------------------------------------------------------------
+// FaultLog::FaultLog
+// 	Create (or truncate) the CSV file, and write its header line.
+//
+//	"fileName" is the UNIX file to write the faults to
+//----------------------------------------------------------------------
+
+FaultLog::FaultLog(char *fileName)
+{
+    fd = OpenForWrite(fileName);
+    buffer = new char[FaultLogBuffer];
+    count = 0;
+    processes = lastProcess = NULL;
+    Write("pid,vpn,kind,pages,start,ticks,victim_pid,victim_vpn,"
+		"victim_dirty\n");
+}
+
+//----------------------------------------------------------------------
+// FaultLog::~FaultLog
+// 	Print the counters of every process that faulted, and write out
+//	the rest of the file.
+//----------------------------------------------------------------------
+
+FaultLog::~FaultLog()
+{
+    ProcessFaults *p;
+
+    if (processes != NULL)
+	printf("Faults by process:\n");
+    while (processes != NULL) {
+	p = processes;
+	printf("  %d %s: %d faults, %.1f ticks on average, %d at most; "
+		"%d pages evicted, %d dirty\n", p->pid, p->name, p->faults,
+		(p->faults > 0) ? (double) p->ticks / p->faults : 0.0,
+		p->maxTicks, p->evicted, p->dirty);
+	processes = p->next;
+	delete [] p->name;
+	delete p;
+    }
+    Flush();
+    Close(fd);
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// FaultLog::CountersOf
+// 	Return the counters of the process of "space", starting them if
+//	this is the first we hear of it.
+//----------------------------------------------------------------------
+
+ProcessFaults *
+FaultLog::CountersOf(AddrSpace *space)
+{
+    ProcessFaults *p = space->faultCounts;
+    char *name;
+
+    if (p != NULL)
+	return p;
+    name = (space->GetName() != NULL) ? space->GetName() : (char *) "?";
+    p = new ProcessFaults;
+    p->pid = space->GetPid();
+    p->name = new char[strlen(name) + 1];
+    strcpy(p->name, name);
+    p->faults = p->ticks = p->maxTicks = 0;
+    p->evicted = p->dirty = 0;
+    p->next = NULL;
+    if (lastProcess == NULL)
+	processes = p;
+    else
+	lastProcess->next = p;
+    lastProcess = p;
+    space->faultCounts = p;		// the counters outlive the space
+    return p;
+}
+
+//----------------------------------------------------------------------
+// FaultLog::Record
+// 	Write one page fault to the file, and count it.
+//
+//	"space" and "vpn" are the page that faulted
+//	"kind" tells how the fault was served
+//	"pages" is the number of pages brought in
+//	"start" is when the fault happened, "ticks" how long it took
+//	"victimPid" and "victimVpn" are the first page evicted to make
+//		room, and "victimDirty" whether it was written back;
+//		"victimVpn" is -1 if no page was evicted
+//----------------------------------------------------------------------
+
+void
+FaultLog::Record(AddrSpace *space, int vpn, FaultKind kind, int pages,
+		int start, int ticks, int victimPid, int victimVpn,
+		bool victimDirty)
+{
+    ProcessFaults *p = CountersOf(space);
+    char line[128];
+
+    p->faults++;
+    p->ticks += ticks;
+    if (ticks > p->maxTicks)
+	p->maxTicks = ticks;
+    sprintf(line, "%d,%d,%s,%d,%d,%d,%d,%d,%d\n", space->GetPid(), vpn,
+		kindNames[kind], pages, start, ticks,
+		(victimVpn != -1) ? victimPid : -1, victimVpn,
+		victimDirty ? 1 : 0);
+    Write(line);
+}
+
+//----------------------------------------------------------------------
+// FaultLog::Evicted
+// 	Count a page of "space" that was evicted, by a fault or by the
+//	pageout daemon; "dirty" if it had to be written back.
+//----------------------------------------------------------------------
+
+void
+FaultLog::Evicted(AddrSpace *space, bool dirty)
+{
+    ProcessFaults *p = CountersOf(space);
+
+    p->evicted++;
+    if (dirty)
+	p->dirty++;
+}
+
+//----------------------------------------------------------------------
+// FaultLog::Write, FaultLog::Flush
+// 	Add a line to the buffer, writing the buffer to the file first
+//	if it does not fit.
+//----------------------------------------------------------------------
+
+void
+FaultLog::Write(char *line)
+{
+    int length = strlen(line);
+
+    if (count + length > FaultLogBuffer)
+	Flush();
+    bcopy(line, buffer + count, length);
+    count += length;
+}
+
+void
+FaultLog::Flush()
+{
+    if (count > 0)
+	WriteFile(fd, buffer, count);
+    count = 0;
+}
@@ -0,0 +1,72 @@
+// faultlog.h
+//	Data structures for recording every page fault (see "-faults").
+//
+//	Each fault is written, as a line of CSV, to a UNIX file: which
+//	process faulted on which page, how the fault was served, how
+//	many ticks went by until the process could go on, and which
+//	page, if any, was evicted to make room, and whether it had to be
+//	written back.  The columns are
+//
+//	pid,vpn,kind,pages,start,ticks,victim_pid,victim_vpn,victim_dirty
+//
+//	where "kind" is one of "reclaim" (the page was still in a free
+//	frame), "shared" (another process had its code page in memory),
+//	"zero" or "read", "pages" is how many pages were brought in at
+//	once, and the victim is -1,-1 if a free frame was used.
+//
+//	The log also keeps counters per process, printed when Nachos
+//	halts, right after the statistics.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FAULTLOG_H
+#define FAULTLOG_H
+
+#include "copyright.h"
+
+#define FaultLogBuffer	4096		// bytes of CSV buffered per write
+
+class AddrSpace;
+
+// How a page fault was served
+enum FaultKind { FaultReclaim, FaultShared, FaultZero, FaultRead };
+
+// The faults of one process, and the evictions of its pages
+class ProcessFaults {
+  public:
+    int pid;				// SpaceId of the process
+    char *name;				// its program
+    int faults;
+    int ticks;				// total latency of the faults
+    int maxTicks;
+    int evicted;			// pages evicted
+    int dirty;				// of which written back
+    ProcessFaults *next;
+};
+
+class FaultLog {
+  public:
+    FaultLog(char *fileName);		// create the CSV file
+    ~FaultLog();			// print the counters, close the file
+
+    void Record(AddrSpace *space, int vpn, FaultKind kind, int pages,
+		int start, int ticks, int victimPid, int victimVpn,
+		bool victimDirty);	// one fault
+    void Evicted(AddrSpace *space, bool dirty);
+					// a page of "space" was evicted
+
+  private:
+    ProcessFaults *CountersOf(AddrSpace *space);
+    void Write(char *line);		// add a line to the file
+    void Flush();
+
+    int fd;				// UNIX file descriptor
+    char *buffer;			// CSV not yet written
+    int count;				// bytes in the buffer
+    ProcessFaults *processes;		// counters, in order of the
+    ProcessFaults *lastProcess;		// first fault of each process
+};
+
+#endif // FAULTLOG_H
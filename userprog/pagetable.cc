@@ -0,0 +1,147 @@
+// pagetable.cc
+//	Routines to manage the two-level page table of an address space.
+//	See pagetable.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "pagetable.h"
+
+//----------------------------------------------------------------------
+// Account
+// 	Record that the page tables grew (or shrank) by "bytes", and
+//	linear page tables for the same address spaces by "linear",
+//	so the footprints can be compared (see -ipt).
+//----------------------------------------------------------------------
+
+static void
+Account(int bytes, int linear)
+{
+    stats->pageTableBytes += bytes;
+    stats->linearTableBytes += linear;
+    if (stats->pageTableBytes > stats->maxPageTableBytes)
+	stats->maxPageTableBytes = stats->pageTableBytes;
+    if (stats->linearTableBytes > stats->maxLinearTableBytes)
+	stats->maxLinearTableBytes = stats->linearTableBytes;
+}
+
+//----------------------------------------------------------------------
+// PageTable::PageTable
+// 	Make an empty directory for "pages" virtual pages.
+//----------------------------------------------------------------------
+
+PageTable::PageTable(int pages)
+{
+    numSpans = divRoundUp(pages, PageTableSpan);
+    directory = new TranslationEntry*[numSpans];
+    info = new PageInfo*[numSpans];
+    for (int s = 0; s < numSpans; s++) {
+	directory[s] = NULL;
+	info[s] = NULL;
+    }
+    numTables = 0;
+    Account(numSpans * sizeof(TranslationEntry *),
+		numSpans * PageTableSpan * sizeof(TranslationEntry));
+}
+
+PageTable::~PageTable()
+{
+    Account(-numSpans * (int) sizeof(TranslationEntry *)
+		- numTables * PageTableSpan * (int) sizeof(TranslationEntry),
+	    -numSpans * PageTableSpan * (int) sizeof(TranslationEntry));
+    for (int s = 0; s < numSpans; s++) {
+	delete [] directory[s];
+	delete [] info[s];
+    }
+    delete [] directory;
+    delete [] info;
+}
+
+//----------------------------------------------------------------------
+// PageTable::MakeTable
+// 	Allocate the second-level tables of span "span", every page in
+//	it invalid and all zeroes.
+//----------------------------------------------------------------------
+
+void
+PageTable::MakeTable(int span)
+{
+    TranslationEntry *entries = new TranslationEntry[PageTableSpan];
+    PageInfo *pages = new PageInfo[PageTableSpan];
+
+    for (int i = 0; i < PageTableSpan; i++) {
+	entries[i].virtualPage = span * PageTableSpan + i;
+	entries[i].physicalPage = -1;
+	entries[i].valid = FALSE;
+	entries[i].readOnly = FALSE;
+	entries[i].use = FALSE;
+	entries[i].dirty = FALSE;
+	pages[i].backing = ZeroFill;
+	pages[i].swapSlot = -1;
+	pages[i].copyOnWrite = FALSE;
+    }
+    directory[span] = entries;
+    info[span] = pages;
+    numTables++;
+    Account(PageTableSpan * sizeof(TranslationEntry), 0);
+}
+
+//----------------------------------------------------------------------
+// PageTable::Lookup
+// 	Return the entry of virtual page "vpn", or NULL if no page of its
+//	span has been used.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Lookup(int vpn)
+{
+    ASSERT(vpn >= 0 && vpn < numSpans * PageTableSpan);
+    if (directory[vpn / PageTableSpan] == NULL)
+	return NULL;
+    return &directory[vpn / PageTableSpan][vpn % PageTableSpan];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Entry, PageTable::Info
+// 	Return the entry, or the kernel's information, of virtual page
+//	"vpn", making its span's tables first if need be.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Entry(int vpn)
+{
+    ASSERT(vpn >= 0 && vpn < numSpans * PageTableSpan);
+    if (directory[vpn / PageTableSpan] == NULL)
+	MakeTable(vpn / PageTableSpan);
+    return &directory[vpn / PageTableSpan][vpn % PageTableSpan];
+}
+
+PageInfo *
+PageTable::Info(int vpn)
+{
+    ASSERT(vpn >= 0 && vpn < numSpans * PageTableSpan);
+    if (info[vpn / PageTableSpan] == NULL)
+	MakeTable(vpn / PageTableSpan);
+    return &info[vpn / PageTableSpan][vpn % PageTableSpan];
+}
+
+//----------------------------------------------------------------------
+// PageTable::NextUsed
+// 	Return the first virtual page, from "vpn" on, whose span has
+//	tables, or -1 if there is none; to visit every page that may
+//	be in use:
+//
+//	for (vpn = t->NextUsed(0); vpn != -1; vpn = t->NextUsed(vpn + 1))
+//----------------------------------------------------------------------
+
+int
+PageTable::NextUsed(int vpn)
+{
+    for (int s = vpn / PageTableSpan; s < numSpans; s++)
+	if (directory[s] != NULL)
+	    return (s == vpn / PageTableSpan) ? vpn : s * PageTableSpan;
+    return -1;
+}
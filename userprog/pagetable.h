@@ -0,0 +1,67 @@
+// pagetable.h
+//	Data structures for the two-level page table of an address space.
+//
+//	The virtual address space is cut into spans of PageTableSpan
+//	pages.  The directory has a slot per span, pointing to the
+//	second-level table of translation entries for its pages, or NULL
+//	if none of them has been used yet; the machine walks it on every
+//	reference (see Machine::Translate).  An address space thus pays
+//	only for the spans it touches, however large it is: room for the
+//	heap to grow and for a deep stack costs nothing until it is used.
+//
+//	Alongside each second-level table, the kernel keeps what it needs
+//	to know about the same pages when they are not in memory.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+#include "copyright.h"
+#include "machine.h"
+
+// Where the contents of a virtual page are, when it is not in memory
+enum PageBacking { ZeroFill,		// nowhere yet; it is all zeroes
+		   InExecutable,	// unmodified code or initialized data
+		   InSwap,		// in its swap slot
+		   InFile		// in a file mapped with Map
+};
+
+// The kernel's side of a page table entry
+class PageInfo {
+  public:
+    PageBacking backing;		// where the page is
+    int swapSlot;			// -1 if it has never been written out
+    bool copyOnWrite;			// read-only only until written
+};
+
+class PageTable {
+  public:
+    PageTable(int pages);		// "pages" virtual pages, none of
+					// them used yet
+    ~PageTable();
+
+    TranslationEntry *Lookup(int vpn);	// entry of "vpn", or NULL if its
+					// span has no table yet
+    TranslationEntry *Entry(int vpn);	// the same, making the table
+    PageInfo *Info(int vpn);		// kernel info of "vpn", making the
+					// table
+    int NextUsed(int vpn);		// first page from "vpn" on whose
+					// span has a table, or -1
+
+    TranslationEntry **GetDirectory() { return directory; }
+    int GetNumSpans() { return numSpans; }
+    int GetNumTables() { return numTables; }
+
+  private:
+    void MakeTable(int span);		// allocate the tables of "span"
+
+    TranslationEntry **directory;	// second-level tables, by span
+    PageInfo **info;			// and the kernel's side of them
+    int numSpans;			// slots in the directory
+    int numTables;			// second-level tables allocated
+};
+
+#endif // PAGETABLE_H
@@ -0,0 +1,149 @@
+// proctable.cc
+//	Routines to allocate SpaceIds, and to let a process wait for
+//	its children to exit.  See proctable.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "proctable.h"
+
+//----------------------------------------------------------------------
+// ProcessTable::ProcessTable
+// 	Initialize an empty process table.
+//----------------------------------------------------------------------
+
+ProcessTable::ProcessTable()
+{
+    procs = new Process[MaxProcesses];
+    for (int i = 0; i < MaxProcesses; i++) {
+	procs[i].space = NULL;
+	procs[i].done = NULL;
+    }
+    used = new BitMap(MaxProcesses);
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::~ProcessTable
+// 	De-allocate the process table; the processes in it are gone.
+//----------------------------------------------------------------------
+
+ProcessTable::~ProcessTable()
+{
+    for (int i = 0; i < MaxProcesses; i++)
+	delete procs[i].done;
+    delete [] procs;
+    delete used;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Add
+// 	Give a SpaceId to a new process, and record it in "space".
+//
+//	"space" is the address space of the process
+//	"parent" is the SpaceId of the process that created it, or -1
+//	"since" is stats->totalTicks when its creation was asked for
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Add(AddrSpace *space, int parent, int since)
+{
+    int id = used->Find();
+
+    if (id == -1)
+	return -1;
+    procs[id].space = space;
+    procs[id].parent = parent;
+    procs[id].status = 0;
+    procs[id].execTicks = since;
+    procs[id].done = new Semaphore("join", 0);
+    space->SetPid(id);
+    DEBUG('a', "Process %d created by %d\n", id, parent);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Started
+// 	A process started by Exec is about to run its first user
+//	instruction; add the time it took to get there to the spawn
+//	latency statistics.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Started(int id)
+{
+    int latency = stats->totalTicks - procs[id].execTicks;
+
+    stats->numSpawns++;
+    stats->spawnTicks += latency;
+    if (latency > stats->maxSpawnTicks)
+	stats->maxSpawnTicks = latency;
+    DEBUG('a', "Process %d started %d ticks after Exec\n", id, latency);
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Join
+// 	Wait until a child process exits, and return its exit status.
+//	Its entry is then freed, so it can only be joined once.
+//
+//	"id" is the SpaceId of the child
+//	"caller" is the SpaceId of the process calling Join
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Join(int id, int caller)
+{
+    int status;
+
+    if (id < 0 || id >= MaxProcesses || !used->Test(id)
+		|| procs[id].parent != caller || caller == -1)
+	return -1;
+    procs[id].done->P();		// until it exits
+    status = procs[id].status;
+    Free(id);
+    return status;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Exit
+// 	A process has exited (its address space is already deleted).
+//	Wake up its parent if it is joining it, or free its entry if
+//	nobody can; its children are orphans from now on.
+//
+//	"id" is the SpaceId of the process, or -1 if it had none
+//	"status" is its exit status
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Exit(int id, int status)
+{
+    if (id == -1)
+	return;
+    for (int i = 0; i < MaxProcesses; i++)
+	if (used->Test(i) && procs[i].parent == id) {
+	    procs[i].parent = -1;
+	    if (procs[i].space == NULL)	// nobody will join it now
+		Free(i);
+	}
+    procs[id].space = NULL;
+    procs[id].status = status;
+    if (procs[id].parent == -1)
+	Free(id);
+    else
+	procs[id].done->V();
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Free
+// 	Make the entry of a process that is gone available again.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Free(int id)
+{
+    delete procs[id].done;
+    procs[id].done = NULL;
+    used->Clear(id);
+}
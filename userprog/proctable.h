@@ -0,0 +1,62 @@
+// proctable.h
+//	Data structures to keep track of the user processes, for the
+//	Exec, Join and Exit system calls.
+//
+//	Every process (address space) gets a SpaceId, the index of its
+//	entry in the process table.  A process started by Exec or Fork
+//	records its parent; only the parent may Join it.  When a process
+//	exits, its entry stays around with the exit status until the
+//	parent joins it, or until the parent exits too; a process whose
+//	parent is gone (or that was started from the command line) frees
+//	its entry as soon as it exits.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROCTABLE_H
+#define PROCTABLE_H
+
+#include "copyright.h"
+#include "bitmap.h"
+#include "synch.h"
+
+#define MaxProcesses	64	// entries in the process table
+
+class AddrSpace;
+
+// What the process table knows about one process
+class Process {
+  public:
+    AddrSpace *space;			// NULL once the process has exited
+    int parent;				// SpaceId of the parent, or -1
+    int status;				// exit status, once it has exited
+    int execTicks;			// when Exec was called for it
+    Semaphore *done;			// the parent waits here in Join
+};
+
+class ProcessTable {
+  public:
+    ProcessTable();			// no process yet
+    ~ProcessTable();
+
+    int Add(AddrSpace *space, int parent, int since);
+					// enter "space" into the table,
+					// "since" being the time of the
+					// Exec; return its SpaceId, or -1
+					// if the table is full
+    void Started(int id);		// the process runs its first
+					// instruction: count the latency
+    int Join(int id, int caller);	// wait for child "id" of "caller"
+					// to exit; return its status, or
+					// -1 if it is not such a child
+    void Exit(int id, int status);	// the process is gone
+
+  private:
+    void Free(int id);			// recycle the entry
+
+    Process *procs;			// indexed by SpaceId
+    BitMap *used;			// entries in use
+};
+
+#endif // PROCTABLE_H
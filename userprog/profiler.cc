@@ -0,0 +1,342 @@
+// profiler.cc
+//	Routines to count the instructions executed by user programs,
+//	and to print the counts against the program's symbols.
+//
+//	The counters are plain arrays, grown as higher PCs and pages show
+//	up, so that counting an instruction costs only a few increments.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "opcodes.h"
+#include "profiler.h"
+
+// The few bits of the MIPS COFF format (see bin/coff.h and <syms.h>)
+// that we need to find the external symbols of a program.
+#define CoffMagic		0x0162	// MIPS little-endian
+#define CoffSymPtr		8	// file header: offset of symbolic header
+#define SymHdrIssExtMax		64	// symbolic header: size of the
+#define SymHdrCbSsExtOffset	68	//    external strings, and offset
+#define SymHdrIextMax		88	//    number of external symbols,
+#define SymHdrCbExtOffset	92	//    and offset
+#define ExtSize			16	// bytes per external symbol
+#define ExtIss			4	// external symbol: offset of name
+#define ExtValue		8	//    address
+#define ExtBits			12	//    type and storage class
+#define StorageText		1	// storage class of a text symbol
+
+//----------------------------------------------------------------------
+// ReadWord
+// 	Read a little-endian word from "offset" in a host file.  Return
+//	FALSE if the file is too short.
+//----------------------------------------------------------------------
+
+static bool
+ReadWord(int fd, int offset, int *word)
+{
+    Lseek(fd, offset, 0);
+    if (ReadPartial(fd, (char *) word, sizeof(int)) != sizeof(int))
+	return FALSE;
+    *word = WordToHost(*word);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Grow
+// 	Return a copy of the counter array "array", with room for at
+//	least "index" + 1 counters.  The new counters are zero.
+//----------------------------------------------------------------------
+
+static int *
+Grow(int *array, int oldSize, int newSize)
+{
+    int *bigger = new int[newSize];
+
+    bzero(bigger, newSize * sizeof(int));
+    if (array != NULL) {
+	bcopy(array, bigger, oldSize * sizeof(int));
+	delete [] array;
+    }
+    return bigger;
+}
+
+static int
+NewSize(int size, int index)
+{
+    if (size == 0)
+	size = 256;
+    while (size <= index)
+	size *= 2;
+    return size;
+}
+
+//----------------------------------------------------------------------
+// Profiler::Profiler
+// 	Initialize an empty profile.
+//----------------------------------------------------------------------
+
+Profiler::Profiler()
+{
+    pcCounts = loads = stores = NULL;
+    numPCs = numPages = total = 0;
+    opCounts = Grow(NULL, 0, NumOpcodes());
+    symbols = NULL;
+    numSymbols = 0;
+    symbolsOf = NULL;
+}
+
+//----------------------------------------------------------------------
+// Profiler::~Profiler
+// 	De-allocate the counts and the symbols.
+//----------------------------------------------------------------------
+
+Profiler::~Profiler()
+{
+    delete [] pcCounts;
+    delete [] opCounts;
+    delete [] loads;
+    delete [] stores;
+    FreeSymbols();
+}
+
+//----------------------------------------------------------------------
+// Profiler::FreeSymbols
+// 	Forget the symbols loaded, if any.
+//----------------------------------------------------------------------
+
+void
+Profiler::FreeSymbols()
+{
+    for (int i = 0; i < numSymbols; i++)
+	delete [] symbols[i].name;
+    delete [] symbols;
+    symbols = NULL;
+    numSymbols = 0;
+    delete [] symbolsOf;
+    symbolsOf = NULL;
+}
+
+//----------------------------------------------------------------------
+// Profiler::LoadSymbols
+// 	Read the text symbols of the user program "fileName" from the
+//	COFF file it was built from, "fileName.coff", instead of those
+//	of the program loaded before, if any.  Without symbols the
+//	profile is printed with bare PCs.  Nothing is done if they are
+//	already the symbols of "fileName" (or it has none), as when a
+//	program Execs the same one over and over.
+//----------------------------------------------------------------------
+
+void
+Profiler::LoadSymbols(char *fileName)
+{
+    char *coffName;
+    int fd, magic, symPtr, numExt, extOffset, strSize, strOffset;
+    char *strings;
+
+    if (symbolsOf != NULL && !strcmp(symbolsOf, fileName))
+	return;
+    FreeSymbols();
+    symbolsOf = new char[strlen(fileName) + 1];
+    strcpy(symbolsOf, fileName);
+    coffName = new char[strlen(fileName) + 6];
+    sprintf(coffName, "%s.coff", fileName);
+    fd = OpenForReadWrite(coffName, FALSE);
+    if (fd < 0) {
+	printf("Profile: no symbols, cannot open %s\n", coffName);
+	delete [] coffName;
+	return;
+    }
+    if (!ReadWord(fd, 0, &magic) || (magic & 0xffff) != CoffMagic
+		|| !ReadWord(fd, CoffSymPtr, &symPtr)
+		|| !ReadWord(fd, symPtr + SymHdrIssExtMax, &strSize)
+		|| !ReadWord(fd, symPtr + SymHdrCbSsExtOffset, &strOffset)
+		|| !ReadWord(fd, symPtr + SymHdrIextMax, &numExt)
+		|| !ReadWord(fd, symPtr + SymHdrCbExtOffset, &extOffset)) {
+	printf("Profile: no symbols, %s is not a MIPS COFF file\n", coffName);
+	Close(fd);
+	delete [] coffName;
+	return;
+    }
+
+    strings = new char[strSize + 1];
+    Lseek(fd, strOffset, 0);
+    strSize = ReadPartial(fd, strings, strSize);
+    strings[(strSize < 0) ? 0 : strSize] = '\0';
+
+    symbols = new ProfileSymbol[numExt];
+    for (int i = 0; i < numExt; i++) {
+	int iss, value, bits, j;
+
+	if (!ReadWord(fd, extOffset + i * ExtSize + ExtIss, &iss)
+		|| !ReadWord(fd, extOffset + i * ExtSize + ExtValue, &value)
+		|| !ReadWord(fd, extOffset + i * ExtSize + ExtBits, &bits))
+	    break;
+	if (((bits >> 6) & 0x1f) != StorageText || iss < 0 || iss >= strSize)
+	    continue;
+
+	// keep the symbols sorted; of several names for the same
+	// address, prefer one that is not a linker-made "_name"
+	for (j = numSymbols; j > 0 && symbols[j - 1].address > value; j--)
+	    symbols[j] = symbols[j - 1];
+	if (j > 0 && symbols[j - 1].address == value) {
+	    if (symbols[j - 1].name[0] == '_' && strings[iss] != '_') {
+		delete [] symbols[j - 1].name;
+		symbols[j - 1].name = new char[strlen(&strings[iss]) + 1];
+		strcpy(symbols[j - 1].name, &strings[iss]);
+	    }
+	    for (; j < numSymbols; j++)		// undo the shift
+		symbols[j] = symbols[j + 1];
+	    continue;
+	}
+	symbols[j].address = value;
+	symbols[j].name = new char[strlen(&strings[iss]) + 1];
+	strcpy(symbols[j].name, &strings[iss]);
+	numSymbols++;
+    }
+    DEBUG('a', "Profile: %d symbols from %s\n", numSymbols, coffName);
+
+    delete [] strings;
+    Close(fd);
+    delete [] coffName;
+}
+
+//----------------------------------------------------------------------
+// Profiler::Count
+// 	Called by the simulated CPU each time it completes an instruction.
+//
+//	"pc" is the address of the instruction
+//	"opCode" is its decoded opcode
+//	"addr" is the memory address it referenced, if it is a load or
+//		store
+//----------------------------------------------------------------------
+
+void
+Profiler::Count(int pc, int opCode, int addr)
+{
+    unsigned int index = (unsigned) pc / 4;
+    unsigned int vpn;
+
+    if (index >= (unsigned) numPCs) {
+	int size = NewSize(numPCs, index);
+
+	pcCounts = Grow(pcCounts, numPCs, size);
+	numPCs = size;
+    }
+    pcCounts[index]++;
+    opCounts[opCode]++;
+    total++;
+
+    if (IsLoad(opCode) || IsStore(opCode)) {
+	vpn = (unsigned) addr / PageSize;
+	if (vpn >= (unsigned) numPages) {
+	    int size = NewSize(numPages, vpn);
+
+	    loads = Grow(loads, numPages, size);
+	    stores = Grow(stores, numPages, size);
+	    numPages = size;
+	}
+	if (IsStore(opCode))
+	    stores[vpn]++;
+	else
+	    loads[vpn]++;
+    }
+}
+
+//----------------------------------------------------------------------
+// Profiler::SymbolFor
+// 	Return the name of the routine containing "pc", and the offset
+//	of "pc" in it; NULL if "pc" is below every symbol.
+//----------------------------------------------------------------------
+
+char *
+Profiler::SymbolFor(int pc, int *offset)
+{
+    int lo = 0, hi = numSymbols - 1;
+
+    if (numSymbols == 0 || pc < symbols[0].address)
+	return NULL;
+    while (lo < hi) {		// find the last symbol at or before pc
+	int mid = (lo + hi + 1) / 2;
+
+	if (symbols[mid].address <= pc)
+	    lo = mid;
+	else
+	    hi = mid - 1;
+    }
+    *offset = pc - symbols[lo].address;
+    return symbols[lo].name;
+}
+
+//----------------------------------------------------------------------
+// Profiler::Print
+// 	Print the instruction counts per routine, the hottest
+//	instructions, the counts per opcode, and the loads and stores
+//	per page.
+//----------------------------------------------------------------------
+
+void
+Profiler::Print()
+{
+    int *perSymbol = Grow(NULL, 0, numSymbols + 1);	// last: no symbol
+    int i, j, offset;
+    char *name;
+    double percent = (total > 0) ? 100.0 / total : 0.0;
+
+    printf("\nProfile: %d user instructions\n", total);
+
+    for (i = 0; i < numPCs; i++) {
+	if (pcCounts[i] == 0)
+	    continue;
+	name = SymbolFor(i * 4, &offset);
+	j = numSymbols;
+	if (name != NULL)
+	    for (j = 0; symbols[j].name != name; j++)
+		;
+	perSymbol[j] += pcCounts[i];
+    }
+    printf("%-20s %10s %7s\n", "Routine", "Count", "%");
+    for (j = 0; j <= numSymbols; j++)
+	if (perSymbol[j] > 0)
+	    printf("%-20s %10d %6.2f%%\n",
+		   (j < numSymbols) ? symbols[j].name : "?",
+		   perSymbol[j], perSymbol[j] * percent);
+    delete [] perSymbol;
+
+    // the hottest instructions, by repeated selection
+    printf("\n%-10s %10s %7s  %s\n", "PC", "Count", "%", "Where");
+    for (int last = -1, rank = 0; rank < ProfileTopPCs; rank++) {
+	int best = -1;
+
+	for (i = 0; i < numPCs; i++)
+	    if (pcCounts[i] > 0
+		  && (last < 0 || pcCounts[i] < pcCounts[last]
+			|| (pcCounts[i] == pcCounts[last] && i > last))
+		  && (best < 0 || pcCounts[i] > pcCounts[best]))
+		best = i;
+	if (best < 0)
+	    break;
+	printf("0x%-8x %10d %6.2f%%  ", best * 4, pcCounts[best],
+	       pcCounts[best] * percent);
+	name = SymbolFor(best * 4, &offset);
+	if (name != NULL)
+	    printf("%s+0x%x\n", name, offset);
+	else
+	    printf("?\n");
+	last = best;
+    }
+
+    printf("\n%-10s %10s %7s\n", "Opcode", "Count", "%");
+    for (i = 0; i < NumOpcodes(); i++)
+	if (opCounts[i] > 0)
+	    printf("%-10.*s %10d %6.2f%%\n",
+		   (int) strcspn(OpcodeString(i), " "),
+		   OpcodeString(i), opCounts[i], opCounts[i] * percent);
+
+    printf("\n%-10s %10s %10s\n", "Page", "Loads", "Stores");
+    for (i = 0; i < numPages; i++)
+	if (loads[i] > 0 || stores[i] > 0)
+	    printf("%-10d %10d %10d\n", i, loads[i], stores[i]);
+}
@@ -0,0 +1,67 @@
+// profiler.h
+//	Data structures for an instruction-level profile of user programs.
+//
+//	With "-prof", the simulated CPU reports every instruction it
+//	completes: we count how many times each PC and each opcode was
+//	executed, and how many loads and stores went to each virtual page.
+//	An instruction that traps (for instance on a page fault) and is
+//	restarted is only counted once, when it finally completes.
+//
+//	When Nachos halts, the counts are printed, with PCs resolved to
+//	the routine names of one program: the last one started by Exec,
+//	or else the one "-x" (or the first one "-xm") ran.  A NOFF file
+//	has no symbols, so we look for the COFF file it was made from
+//	("<program>.coff", as left in the test directory by the build)
+//	and use its external text symbols.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "copyright.h"
+
+#define ProfileTopPCs	10	// hottest instructions to list
+
+// A routine in the program text, from the COFF symbol table
+class ProfileSymbol {
+  public:
+    int address;		// first instruction of the routine
+    char *name;
+};
+
+class Profiler {
+  public:
+    Profiler();				// start with empty counts
+    ~Profiler();
+
+    void LoadSymbols(char *fileName);	// find the symbols for the NOFF
+					// program "fileName"
+    void Count(int pc, int opCode, int addr);
+					// the instruction at "pc" completed;
+					// "addr" is its effective address
+					// if it is a load or store
+    void Print();			// print the profile
+
+  private:
+    char *SymbolFor(int pc, int *offset);
+					// routine containing "pc"
+    void FreeSymbols();			// forget them
+
+    int *pcCounts;		// executions, indexed by PC / 4
+    int numPCs;
+    int *opCounts;		// executions, indexed by opcode
+    int *loads;			// loads and stores, indexed by
+    int *stores;		// virtual page number
+    int numPages;
+    int total;			// instructions counted
+
+    ProfileSymbol *symbols;	// sorted by address
+    int numSymbols;
+    char *symbolsOf;		// program they were loaded for, NULL
+				// if none
+};
+
+#endif // PROFILER_H
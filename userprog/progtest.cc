@@ -13,6 +13,7 @@
 #include "console.h"
 #include "addrspace.h"
 #include "synch.h"
+#include "checkpoint.h"
 
 //----------------------------------------------------------------------
 // StartProcess
@@ -31,10 +32,11 @@ StartProcess(char *filename)
 	return;
     }
     space = new AddrSpace(executable,filename);    
+    if (profiler != NULL)
+	profiler->LoadSymbols(filename);
 
-    currentThread->space = space;
-
-    delete executable;			// close file
+    currentThread->space = space;	// the space closes the executable
+    processTable->Add(space, -1, stats->totalTicks);
 
     space->InitRegisters();		// set the initial register values
     space->RestoreState();		// load page table register
@@ -44,6 +46,85 @@ StartProcess(char *filename)
 					// by doing the syscall "exit"
 }
 
+//----------------------------------------------------------------------
+// RestoreProcess
+// 	Resume a user program from the checkpoint it saved in the Nachos
+//	file "fileName" (see checkpoint.h): its program must still be
+//	there.  The pages it had modified are put in swap, and it
+//	carries on where it left off, paging in the rest as it goes.
+//----------------------------------------------------------------------
+
+void
+RestoreProcess(char *fileName)
+{
+    int registers[NumTotalRegs];
+    AddrSpace *space = LoadCheckpoint(fileName, registers);
+
+    if (space == NULL) {
+	printf("Unable to restore checkpoint %s\n", fileName);
+	return;
+    }
+    if (profiler != NULL)
+	profiler->LoadSymbols(space->GetName());
+
+    currentThread->space = space;
+    processTable->Add(space, -1, stats->totalTicks);
+
+    for (int i = 0; i < NumTotalRegs; i++)
+	machine->WriteRegister(i, registers[i]);
+    space->RestoreState();		// load page table register
+
+    machine->Run();			// back to the user program
+    ASSERT(FALSE);
+}
+
+//----------------------------------------------------------------------
+// RunProcess
+// 	Body of a thread forked by StartProcesses: jump to the user
+//	program in the thread's address space.
+//----------------------------------------------------------------------
+
+static void
+RunProcess(int dummy)
+{
+    currentThread->space->InitRegisters();
+    currentThread->space->RestoreState();
+    machine->Run();
+    ASSERT(FALSE);
+}
+
+//----------------------------------------------------------------------
+// StartProcesses
+// 	Run several user programs at once, each in its own address space
+//	and thread, sharing physical memory through the core map.  The
+//	programs take turns only when they fault or are preempted, so
+//	use the timer ("-rs").  A program that halts stops all of them;
+//	one that exits only gives its memory back.
+//
+//	"files" are the "count" programs to run; a profile uses the
+//	symbols of the first one
+//----------------------------------------------------------------------
+
+void
+StartProcesses(char **files, int count)
+{
+    for (int i = 0; i < count; i++) {
+	OpenFile *executable = fileSystem->Open(files[i]);
+	Thread *t;
+
+	if (executable == NULL) {
+	    printf("Unable to open file %s\n", files[i]);
+	    continue;
+	}
+	if (i == 0 && profiler != NULL)
+	    profiler->LoadSymbols(files[i]);
+	t = new Thread(files[i]);
+	t->space = new AddrSpace(executable, files[i]);
+	processTable->Add(t->space, -1, stats->totalTicks);
+	t->Fork(RunProcess, 0);
+    }
+}
+
 // Data structures needed for the console test.  Threads making
 // I/O requests wait on a Semaphore to delay until the I/O completes.
 
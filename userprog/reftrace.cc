@@ -0,0 +1,132 @@
+// reftrace.cc
+//	Routines to write the page reference string of user programs to
+//	a host file.  See reftrace.h for the format.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "reftrace.h"
+
+//----------------------------------------------------------------------
+// RefTrace::RefTrace
+// 	Create (or truncate) the trace file, and write its header.
+//
+//	"fileName" is the UNIX file to write the trace to
+//	"pageBytes" is the page size the virtual page numbers refer to
+//----------------------------------------------------------------------
+
+RefTrace::RefTrace(char *fileName, int pageBytes)
+{
+    fd = OpenForWrite(fileName);
+    buffer = new int[RefTraceBuffer];
+    buffer[0] = WordToHost(RefTraceMagic);
+    buffer[1] = WordToHost(pageBytes);
+    count = 2;
+    process = last = -1;
+    repeats = 0;
+    recorded = 0;
+}
+
+//----------------------------------------------------------------------
+// RefTrace::~RefTrace
+// 	Write out what is left of the trace, and close the file.
+//----------------------------------------------------------------------
+
+RefTrace::~RefTrace()
+{
+    PutRepeats();
+    Flush();
+    Close(fd);
+    DEBUG('a', "Recorded %d page references\n", recorded);
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// RefTrace::Record
+// 	Add a reference to the trace; if it repeats the last one, only
+//	count it.  If another process made the last one, say which
+//	process this one comes from first.
+//
+//	"pid" is the SpaceId of the process making the reference
+//	"vpn" is the virtual page referenced
+//	"writing" is TRUE for a store
+//----------------------------------------------------------------------
+
+void
+RefTrace::Record(int pid, unsigned int vpn, bool writing)
+{
+    int word = RefWord(vpn, writing), from = RefSwitchFlag | RefPid(pid);
+
+    recorded++;
+    if (from != process) {
+	PutRepeats();
+	process = from;
+	Put(from);
+	last = -1;
+    }
+    if (word == last) {
+	if (++repeats == RefMaxRepeats)
+	    PutRepeats();
+	return;
+    }
+    PutRepeats();
+    last = word;
+    Put(word);
+}
+
+//----------------------------------------------------------------------
+// RefTrace::Exited
+// 	Note that the process "pid" is gone, along with its pages.  The
+//	next reference says which process makes it.
+//----------------------------------------------------------------------
+
+void
+RefTrace::Exited(int pid)
+{
+    PutRepeats();
+    Put(RefExitFlag | RefPid(pid));
+    process = last = -1;
+}
+
+//----------------------------------------------------------------------
+// RefTrace::Put
+// 	Add "word" to the buffer, writing the buffer out when it is full.
+//----------------------------------------------------------------------
+
+void
+RefTrace::Put(int word)
+{
+    buffer[count++] = WordToHost(word);
+    if (count == RefTraceBuffer)
+	Flush();
+}
+
+//----------------------------------------------------------------------
+// RefTrace::PutRepeats
+// 	Add the number of times the last reference was repeated, if it
+//	was.
+//----------------------------------------------------------------------
+
+void
+RefTrace::PutRepeats()
+{
+    if (repeats > 0)
+	Put(RefRepeatFlag | repeats);
+    repeats = 0;
+}
+
+//----------------------------------------------------------------------
+// RefTrace::Flush
+// 	Write the buffered words to the file.
+//----------------------------------------------------------------------
+
+void
+RefTrace::Flush()
+{
+    if (count > 0)
+	WriteFile(fd, (char *) buffer, count * sizeof(int));
+    count = 0;
+}
@@ -0,0 +1,73 @@
+// reftrace.h
+//	Data structures for recording the page reference string of a
+//	user program, for replay by the page replacement simulator
+//	(vm/refsim.cc).
+//
+//	A trace is a host file of little-endian words: RefTraceMagic, the
+//	page size, and then one word per reference, (vpn << 1) | write.
+//	A reference identical to the one just before it is not written
+//	again: a run of them is written as its first reference, followed
+//	by RefRepeatFlag | the number of repeats.  The repeats cannot
+//	fault, but they count for the policies that count references
+//	(LFU, aging), so the simulator replays them all.
+//
+//	Every process has its own virtual pages, so the references are
+//	preceded by RefSwitchFlag | the SpaceId of the process making
+//	them, written again whenever another process makes one.  When a
+//	process goes away, RefExitFlag | its SpaceId is written: its
+//	pages are gone, and a later process may get the same SpaceId.
+//	Pages that processes share in the kernel (code, copy-on-write
+//	pages) are separate pages of each process in the trace.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REFTRACE_H
+#define REFTRACE_H
+
+#include "copyright.h"
+
+#define RefTraceMagic	0x52464e54	// "TNFR" in the file
+#define RefTraceBuffer	1024		// references buffered per write
+
+#define RefWord(vpn, writing)	(((vpn) << 1) | ((writing) ? 1 : 0))
+#define RefPage(word)		((unsigned) (word) >> 1)
+#define RefIsWrite(word)	((word) & 1)
+
+#define RefKindMask		0xc0000000	// what a word holds:
+#define RefRepeatFlag		0x80000000	// a repeat count
+#define RefSwitchFlag		0x40000000	// the process referencing
+#define RefExitFlag		0xc0000000	// a process that went away
+#define RefMaxRepeats		0x3fffffff	// most one word can hold
+#define RefIsRepeat(word)	(((word) & RefKindMask) == RefRepeatFlag)
+#define RefIsSwitch(word)	(((word) & RefKindMask) == RefSwitchFlag)
+#define RefIsExit(word)		(((word) & RefKindMask) == RefExitFlag)
+#define RefRepeats(word)	((word) & RefMaxRepeats)
+#define RefPid(word)		((word) & RefMaxRepeats)
+
+class RefTrace {
+  public:
+    RefTrace(char *fileName, int pageBytes);	// create the trace file
+    ~RefTrace();			// flush and close it
+
+    void Record(int pid, unsigned int vpn, bool writing);
+					// add one reference, by process "pid"
+    void Exited(int pid);		// process "pid" went away
+
+  private:
+    void Put(int word);			// add a word to the buffer
+    void PutRepeats();			// and the pending repeat count
+    void Flush();			// write out the buffer
+
+    int fd;				// UNIX file descriptor
+    int *buffer;			// references not yet written
+    int count;				// how many are in the buffer
+    int process;			// switch word of the process making
+					// the references, -1 if none yet
+    int last;				// the previous reference
+    int repeats;			// times it was repeated since
+    int recorded;			// references recorded
+};
+
+#endif // REFTRACE_H
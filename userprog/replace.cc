@@ -0,0 +1,361 @@
+// replace.cc
+//	Routines implementing the page replacement policies.
+//
+//	Every policy only considers frames that hold a page; ties are
+//	broken in favor of the page that was loaded first.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "utility.h"
+#include "replace.h"
+
+char *replacementPolicies[] = { "fifo", "clock", "lru", "eclock", "aging",
+				"lfu", NULL };
+
+//----------------------------------------------------------------------
+// NewReplacementPolicy
+// 	Return the policy called "name", managing "frames" page frames,
+//	or NULL if there is no such policy.
+//----------------------------------------------------------------------
+
+ReplacementPolicy *
+NewReplacementPolicy(char *name, int frames)
+{
+    if (!strcmp(name, "fifo"))
+	return new FIFOPolicy(frames);
+    else if (!strcmp(name, "clock"))
+	return new ClockPolicy(frames);
+    else if (!strcmp(name, "lru"))
+	return new LRUPolicy(frames);
+    else if (!strcmp(name, "eclock"))
+	return new EnhancedClockPolicy(frames);
+    else if (!strcmp(name, "aging"))
+	return new AgingPolicy(frames);
+    else if (!strcmp(name, "lfu"))
+	return new LFUPolicy(frames);
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ReplacementPolicy::ReplacementPolicy
+// 	Initialize the state common to all policies.
+//
+//	"frames" is the number of page frames to choose from
+//----------------------------------------------------------------------
+
+ReplacementPolicy::ReplacementPolicy(int frames)
+{
+    numFrames = frames;
+    entries = new TranslationEntry*[frames];
+    loadTime = new int[frames];
+    for (int i = 0; i < frames; i++) {
+	entries[i] = NULL;
+	loadTime[i] = 0;
+    }
+    loads = 0;
+    candidates = NULL;
+    sync = NULL;
+}
+
+ReplacementPolicy::~ReplacementPolicy()
+{
+    delete [] entries;
+    delete [] loadTime;
+}
+
+//----------------------------------------------------------------------
+// ReplacementPolicy::Loaded
+// 	Remember which page is now in "frame", and when it got there.
+//----------------------------------------------------------------------
+
+void
+ReplacementPolicy::Loaded(int frame, TranslationEntry *entry)
+{
+    ASSERT(frame >= 0 && frame < numFrames);
+    entries[frame] = entry;
+    loadTime[frame] = ++loads;
+}
+
+//----------------------------------------------------------------------
+// ReplacementPolicy::Freed
+// 	"frame" is empty again; it is no longer a candidate victim.
+//----------------------------------------------------------------------
+
+void
+ReplacementPolicy::Freed(int frame)
+{
+    ASSERT(frame >= 0 && frame < numFrames);
+    entries[frame] = NULL;
+}
+
+//----------------------------------------------------------------------
+// ReplacementPolicy::SelectVictimAmong
+// 	Choose the frame to evict as SelectVictim does, but only among
+//	the frames for which "candidates" is TRUE, at least one of which
+//	must hold a page.  The other frames are left alone, but the
+//	policy still keeps its own bookkeeping for them up to date.
+//----------------------------------------------------------------------
+
+int
+ReplacementPolicy::SelectVictimAmong(bool *which)
+{
+    int victim;
+
+    candidates = which;
+    victim = SelectVictim();
+    candidates = NULL;
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// FIFOPolicy::SelectVictim
+// 	Evict the page that has been in memory the longest.
+//----------------------------------------------------------------------
+
+int
+FIFOPolicy::SelectVictim()
+{
+    int victim = -1;
+
+    for (int i = 0; i < numFrames; i++)
+	if (IsCandidate(i)
+		&& (victim == -1 || loadTime[i] < loadTime[victim]))
+	    victim = i;
+    ASSERT(victim != -1);
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// ClockPolicy::SelectVictim
+// 	Sweep the frames in order, clearing use bits, until a page is
+//	found that has not been used since the hand last passed it.
+//----------------------------------------------------------------------
+
+int
+ClockPolicy::SelectVictim()
+{
+    int victim;
+
+    // at most two sweeps: the first one clears every use bit
+    for (int i = 0; i < 2 * numFrames; i++) {
+	TranslationEntry *entry = entries[hand];
+
+	victim = hand;
+	hand = (hand + 1) % numFrames;
+	if (!IsCandidate(victim))
+	    continue;
+	if (!entry->use)
+	    return victim;
+	entry->use = FALSE;
+    }
+    ASSERT(FALSE);			// no frame in use
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// LRUPolicy
+// 	Stamp every frame with the time of its last reference, and
+//	evict the oldest stamp.
+//----------------------------------------------------------------------
+
+LRUPolicy::LRUPolicy(int frames) : ReplacementPolicy(frames)
+{
+    lastUse = new int[frames];
+    for (int i = 0; i < frames; i++)
+	lastUse[i] = 0;
+    now = 0;
+}
+
+LRUPolicy::~LRUPolicy()
+{
+    delete [] lastUse;
+}
+
+void
+LRUPolicy::Loaded(int frame, TranslationEntry *entry)
+{
+    ReplacementPolicy::Loaded(frame, entry);
+    lastUse[frame] = ++now;
+}
+
+void
+LRUPolicy::Referenced(int frame, bool writing)
+{
+    lastUse[frame] = ++now;
+}
+
+int
+LRUPolicy::SelectVictim()
+{
+    int victim = -1;
+
+    for (int i = 0; i < numFrames; i++)
+	if (IsCandidate(i)
+		&& (victim == -1 || lastUse[i] < lastUse[victim]))
+	    victim = i;
+    ASSERT(victim != -1);
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// EnhancedClockPolicy::SelectVictim
+// 	Classify pages by (use, dirty).  Sweep once looking for a page
+//	that is neither, without touching anything; then sweep looking
+//	for a dirty page that is not used, clearing use bits on the way.
+//	Repeat; after the second sweep no use bit is left, so the next
+//	round always succeeds.
+//----------------------------------------------------------------------
+
+int
+EnhancedClockPolicy::SelectVictim()
+{
+    int i, frame;
+    TranslationEntry *entry;
+
+    for (int round = 0; round < 2; round++) {
+	for (i = 0; i < numFrames; i++) {
+	    frame = (hand + i) % numFrames;
+	    entry = entries[frame];
+	    if (IsCandidate(frame) && !entry->use && !entry->dirty) {
+		hand = (frame + 1) % numFrames;
+		return frame;
+	    }
+	}
+	for (i = 0; i < numFrames; i++) {
+	    frame = (hand + i) % numFrames;
+	    entry = entries[frame];
+	    if (!IsCandidate(frame))
+		continue;
+	    if (!entry->use) {
+		hand = (frame + 1) % numFrames;
+		return frame;
+	    }
+	    entry->use = FALSE;
+	}
+    }
+    ASSERT(FALSE);			// no frame in use
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// AgingPolicy
+// 	Every AgingInterval references, shift each page's history right
+//	and put its use bit in at the top; evict the page with the
+//	smallest history, i.e., the one unused for the longest (as far
+//	as 8 intervals can tell).
+//----------------------------------------------------------------------
+
+AgingPolicy::AgingPolicy(int frames) : ReplacementPolicy(frames)
+{
+    history = new unsigned int[frames];
+    for (int i = 0; i < frames; i++)
+	history[i] = 0;
+    untilAging = AgingInterval;
+}
+
+AgingPolicy::~AgingPolicy()
+{
+    delete [] history;
+}
+
+void
+AgingPolicy::Loaded(int frame, TranslationEntry *entry)
+{
+    ReplacementPolicy::Loaded(frame, entry);
+    history[frame] = 0;
+}
+
+void
+AgingPolicy::Referenced(int frame, bool writing)
+{
+    if (--untilAging == 0) {
+	Age();
+	untilAging = AgingInterval;
+    }
+}
+
+//----------------------------------------------------------------------
+// AgingPolicy::Age
+// 	Shift every page's use bit into its history, candidate or not,
+//	and clear it.  Between faults the use bits may still be sitting
+//	in the TLB, so ask for them first.
+//----------------------------------------------------------------------
+
+void
+AgingPolicy::Age()
+{
+    if (sync != NULL)
+	(*sync)();
+    for (int i = 0; i < numFrames; i++) {
+	if (entries[i] == NULL)
+	    continue;
+	history[i] = (history[i] >> 1) | (entries[i]->use ? 0x80 : 0);
+	entries[i]->use = FALSE;
+    }
+}
+
+int
+AgingPolicy::SelectVictim()
+{
+    int victim = -1;
+
+    Age();				// count the latest use bits too
+    untilAging = AgingInterval;
+    for (int i = 0; i < numFrames; i++)
+	if (IsCandidate(i) && (victim == -1
+		|| history[i] < history[victim]
+		|| (history[i] == history[victim]
+		    && loadTime[i] < loadTime[victim])))
+	    victim = i;
+    ASSERT(victim != -1);
+    return victim;
+}
+
+//----------------------------------------------------------------------
+// LFUPolicy
+// 	Count the references to each frame since its page was loaded,
+//	and evict the page with the fewest.
+//----------------------------------------------------------------------
+
+LFUPolicy::LFUPolicy(int frames) : ReplacementPolicy(frames)
+{
+    count = new int[frames];
+    for (int i = 0; i < frames; i++)
+	count[i] = 0;
+}
+
+LFUPolicy::~LFUPolicy()
+{
+    delete [] count;
+}
+
+void
+LFUPolicy::Loaded(int frame, TranslationEntry *entry)
+{
+    ReplacementPolicy::Loaded(frame, entry);
+    count[frame] = 0;
+}
+
+void
+LFUPolicy::Referenced(int frame, bool writing)
+{
+    count[frame]++;
+}
+
+int
+LFUPolicy::SelectVictim()
+{
+    int victim = -1;
+
+    for (int i = 0; i < numFrames; i++)
+	if (IsCandidate(i) && (victim == -1
+		|| count[i] < count[victim]
+		|| (count[i] == count[victim]
+		    && loadTime[i] < loadTime[victim])))
+	    victim = i;
+    ASSERT(victim != -1);
+    return victim;
+}
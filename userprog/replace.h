@@ -0,0 +1,155 @@
+// replace.h
+//	Data structures for choosing which page to evict from physical
+//	memory when a page fault finds no free frame.
+//
+//	A ReplacementPolicy only sees page frames and the page table entry
+//	of the page held in each frame.  The kernel tells it when a frame
+//	is loaded or freed, asks it for a victim when memory is full, and
+//	(since Nachos can afford to, unlike real hardware) reports every
+//	reference to a frame, which LRU and LFU need.  The other policies
+//	get by with the use and dirty bits of the page table entries.
+//
+//	The policies do not depend on the rest of the kernel, so that
+//	they can also be run over a recorded reference string.
+//
+//	The policies are:
+//	   fifo   -- evict the page that was loaded first
+//	   clock  -- FIFO, but give pages whose use bit is set a second
+//		     chance (the "reloj" algorithm)
+//	   lru    -- evict the page that was referenced longest ago
+//	   eclock -- clock, preferring pages that are neither used nor
+//		     dirty, then dirty but not used pages
+//	   aging  -- keep an 8 bit history of the use bit of every page,
+//		     shifted every AgingInterval references, and evict
+//		     the page with the smallest history
+//	   lfu    -- evict the page referenced least often since it was
+//		     loaded
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef REPLACE_H
+#define REPLACE_H
+
+#include "copyright.h"
+#include "translate.h"
+
+#define AgingInterval	1000	// references between aging shifts
+
+class ReplacementPolicy {
+  public:
+    ReplacementPolicy(int frames);	// all "frames" start out free
+    virtual ~ReplacementPolicy();
+
+    virtual char *Name() = 0;		// name of the policy, as given to
+					// NewReplacementPolicy
+
+    virtual void Loaded(int frame, TranslationEntry *entry);
+					// the page of "entry" was brought
+					// into "frame"
+    virtual void Referenced(int frame, bool writing) {}
+					// the page in "frame" was accessed
+    virtual void Freed(int frame);	// "frame" no longer holds a page
+    virtual int SelectVictim() = 0;	// choose the frame to evict; every
+					// frame must be in use
+    int SelectVictimAmong(bool *candidates);
+					// the same, but only among the
+					// frames "candidates" marks
+
+    TranslationEntry *PageIn(int frame) { return entries[frame]; }
+					// page held by "frame", or NULL
+    void SetSync(VoidNoArgFunctionPtr func) { sync = func; }
+					// call "func" to bring the use
+					// bits up to date before aging
+					// them
+
+  protected:
+    bool IsCandidate(int frame)		// may "frame" be chosen?
+	{ return entries[frame] != NULL
+		&& (candidates == NULL || candidates[frame]); }
+
+    int numFrames;
+    TranslationEntry **entries;		// page in each frame, NULL if free
+    bool *candidates;			// frames SelectVictim may choose,
+					// NULL if all
+    VoidNoArgFunctionPtr sync;		// see SetSync, NULL if none
+    int *loadTime;			// when each frame was loaded
+    int loads;				// number of calls to Loaded
+};
+
+class FIFOPolicy : public ReplacementPolicy {
+  public:
+    FIFOPolicy(int frames) : ReplacementPolicy(frames) {}
+    char *Name() { return "fifo"; }
+    int SelectVictim();
+};
+
+class ClockPolicy : public ReplacementPolicy {
+  public:
+    ClockPolicy(int frames) : ReplacementPolicy(frames) { hand = 0; }
+    char *Name() { return "clock"; }
+    int SelectVictim();
+
+  private:
+    int hand;				// next frame to look at
+};
+
+class LRUPolicy : public ReplacementPolicy {
+  public:
+    LRUPolicy(int frames);
+    ~LRUPolicy();
+    char *Name() { return "lru"; }
+    void Loaded(int frame, TranslationEntry *entry);
+    void Referenced(int frame, bool writing);
+    int SelectVictim();
+
+  private:
+    int *lastUse;			// time of the last reference
+    int now;				// references so far
+};
+
+class EnhancedClockPolicy : public ReplacementPolicy {
+  public:
+    EnhancedClockPolicy(int frames) : ReplacementPolicy(frames) { hand = 0; }
+    char *Name() { return "eclock"; }
+    int SelectVictim();
+
+  private:
+    int hand;				// next frame to look at
+};
+
+class AgingPolicy : public ReplacementPolicy {
+  public:
+    AgingPolicy(int frames);
+    ~AgingPolicy();
+    char *Name() { return "aging"; }
+    void Loaded(int frame, TranslationEntry *entry);
+    void Referenced(int frame, bool writing);
+    int SelectVictim();
+
+  private:
+    void Age();				// shift the use bits into the
+					// histories
+    unsigned int *history;		// use bits, most recent highest
+    int untilAging;			// references left before Age()
+};
+
+class LFUPolicy : public ReplacementPolicy {
+  public:
+    LFUPolicy(int frames);
+    ~LFUPolicy();
+    char *Name() { return "lfu"; }
+    void Loaded(int frame, TranslationEntry *entry);
+    void Referenced(int frame, bool writing);
+    int SelectVictim();
+
+  private:
+    int *count;				// references since loaded
+};
+
+extern char *replacementPolicies[];	// names of all policies, NULL ended
+extern ReplacementPolicy *NewReplacementPolicy(char *name, int frames);
+					// NULL if "name" is unknown
+
+#endif // REPLACE_H
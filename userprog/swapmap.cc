@@ -0,0 +1,176 @@
+// swapmap.cc
+//	Routines to allocate slots in the swap area, and to move pages
+//	between it and memory.  See swapmap.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "swapmap.h"
+
+//----------------------------------------------------------------------
+// SwapMap::SwapMap
+// 	Create the swap area, with every slot free.
+//
+//	"slots" is the size of the swap area, in pages
+//----------------------------------------------------------------------
+
+SwapMap::SwapMap(int slots)
+{
+    numSlots = slots;
+    inUse = new BitMap(slots);
+    reserved = new BitMap(slots);
+    refs = new int[slots];
+    file = NULL;
+    if (fileSystem->Create(SwapFileName, slots * PageSize))
+	file = fileSystem->Open(SwapFileName);
+    if (file == NULL) {
+	printf("Unable to create the swap area %s\n", SwapFileName);
+	ASSERT(FALSE);
+    }
+}
+
+//----------------------------------------------------------------------
+// SwapMap::~SwapMap
+// 	Remove the swap area; nothing in it outlives Nachos.
+//----------------------------------------------------------------------
+
+SwapMap::~SwapMap()
+{
+    delete file;
+    fileSystem->Remove(SwapFileName);
+    delete inUse;
+    delete reserved;
+    delete [] refs;
+}
+
+//----------------------------------------------------------------------
+// SwapMap::ReserveExtent
+// 	Look for "count" free, unreserved slots in a row, and reserve
+//	them for an address space of "count" pages.  Nothing is
+//	allocated.
+//
+//	Return the first slot of the run, or -1 if there is none.
+//----------------------------------------------------------------------
+
+int
+SwapMap::ReserveExtent(int count)
+{
+    int run = 0, i;
+
+    for (i = 0; i < numSlots && run < count; i++)
+	run = (inUse->Test(i) || reserved->Test(i)) ? 0 : run + 1;
+    if (run < count)
+	return -1;
+    for (int j = i - count; j < i; j++)
+	reserved->Mark(j);
+    return i - count;
+}
+
+//----------------------------------------------------------------------
+// SwapMap::ReleaseExtent
+// 	Cancel the reservation of the "count" slots starting at "base".
+//----------------------------------------------------------------------
+
+void
+SwapMap::ReleaseExtent(int base, int count)
+{
+    for (int i = base; i < base + count; i++)
+	reserved->Clear(i);
+}
+
+//----------------------------------------------------------------------
+// SwapMap::Allocate
+// 	Take a free slot: "hint" if it is free, otherwise the first free
+//	slot outside every extent, otherwise the first free slot.
+//	Running out of swap is fatal.
+//
+//	"hint" is the preferred slot, or -1 for none
+//----------------------------------------------------------------------
+
+int
+SwapMap::Allocate(int hint)
+{
+    int slot = hint;
+
+    if (!IsFree(slot))
+	for (slot = 0; slot < numSlots; slot++)
+	    if (!inUse->Test(slot) && !reserved->Test(slot))
+		break;
+    if (slot == numSlots)
+	slot = inUse->Find();
+    if (slot == -1) {
+	printf("Out of swap space (%d pages)\n", numSlots);
+	ASSERT(FALSE);
+    }
+    inUse->Mark(slot);
+    refs[slot] = 1;
+    return slot;
+}
+
+//----------------------------------------------------------------------
+// SwapMap::Share
+// 	One more address space (a forked child) holds "slot".
+//----------------------------------------------------------------------
+
+void
+SwapMap::Share(int slot)
+{
+    ASSERT(slot >= 0 && slot < numSlots && inUse->Test(slot));
+    refs[slot]++;
+}
+
+//----------------------------------------------------------------------
+// SwapMap::IsFree
+// 	Return TRUE if "slot" is a slot of the swap area, and nobody
+//	holds it.
+//----------------------------------------------------------------------
+
+bool
+SwapMap::IsFree(int slot)
+{
+    return slot >= 0 && slot < numSlots && !inUse->Test(slot);
+}
+
+//----------------------------------------------------------------------
+// SwapMap::Free
+// 	Give "slot" back.  It is free once nobody else shares it.
+//----------------------------------------------------------------------
+
+void
+SwapMap::Free(int slot)
+{
+    ASSERT(slot >= 0 && slot < numSlots && inUse->Test(slot));
+    if (--refs[slot] == 0)
+	inUse->Clear(slot);
+}
+
+//----------------------------------------------------------------------
+// SwapMap::Read
+// 	Read "count" pages, from consecutive slots starting at "slot",
+//	into "into", with a single disk request.
+//----------------------------------------------------------------------
+
+void
+SwapMap::Read(int slot, char *into, int count)
+{
+    ASSERT(slot >= 0 && slot + count <= numSlots);
+    file->ReadAt(into, count * PageSize, slot * PageSize);
+    stats->numDiskReads++;
+}
+
+//----------------------------------------------------------------------
+// SwapMap::Write
+// 	Write "count" pages from "from" to consecutive slots starting at
+//	"slot", with a single disk request.
+//----------------------------------------------------------------------
+
+void
+SwapMap::Write(int slot, char *from, int count)
+{
+    ASSERT(slot >= 0 && slot + count <= numSlots);
+    file->WriteAt(from, count * PageSize, slot * PageSize);
+    stats->numDiskWrites++;
+}
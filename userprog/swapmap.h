@@ -0,0 +1,66 @@
+// swapmap.h
+//	Data structures to manage the swap area.
+//
+//	All address spaces page to a single swap area, a file of
+//	"numSlots" page-sized slots created when Nachos starts (the
+//	"SWAP" file).  A bitmap records which slots are in use.  A page
+//	only gets a slot the first time it is written out, and keeps it
+//	until its address space goes away.  A forked child shares its
+//	parent's slots, until either of them writes the page out again.
+//
+//	To keep the pages of a process together, each address space
+//	reserves an extent of slots, a free run as long as the address
+//	space, and page N is put in slot N of its extent.  Reserving
+//	does not allocate: other address spaces only take reserved
+//	slots when there are no others left.  Pages that are neighbours in the
+//	address space are then neighbours in the swap area too, so they
+//	can be read or written in a single disk request.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAPMAP_H
+#define SWAPMAP_H
+
+#include "copyright.h"
+#include "bitmap.h"
+#include "openfile.h"
+
+#define SwapFileName	"SWAP"		// where the swap area is kept
+#define SwapPerFrame	8		// default swap pages per frame
+
+class SwapMap {
+  public:
+    SwapMap(int slots);			// create an empty swap area of
+					// "slots" pages
+    ~SwapMap();				// and remove it
+
+    int ReserveExtent(int count);	// first slot of a free run of
+					// "count" slots, or -1
+    void ReleaseExtent(int base, int count);
+					// the run is no longer wanted
+    int Allocate(int hint);		// take slot "hint" if it is free,
+					// otherwise any free slot
+    bool IsFree(int slot);		// is "slot" available?
+    void Share(int slot);		// one more holder for "slot"
+    bool IsShared(int slot) { return refs[slot] > 1; }
+    void Free(int slot);		// give a slot back
+
+    void Read(int slot, char *into, int count);
+					// read "count" pages starting at
+					// "slot"
+    void Write(int slot, char *from, int count);
+					// write them
+
+    int NumFree() { return inUse->NumClear(); }
+
+  private:
+    int numSlots;			// size of the swap area, in pages
+    BitMap *inUse;			// which slots are taken
+    BitMap *reserved;			// which are in some extent
+    int *refs;				// address spaces holding each slot
+    OpenFile *file;			// the swap area
+};
+
+#endif // SWAPMAP_H
@@ -0,0 +1,83 @@
+// synchconsole.cc
+//	Routines to use the console synchronously.  See synchconsole.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "synchconsole.h"
+
+// Console interrupt handlers; "arg" is the SynchConsole
+static void ConsoleReadAvail(int arg) { ((SynchConsole *) arg)->ReadAvail(); }
+static void ConsoleWriteDone(int arg) { ((SynchConsole *) arg)->WriteDone(); }
+
+//----------------------------------------------------------------------
+// SynchConsole::SynchConsole
+// 	Initialize the console device, and the semaphores to wait on it.
+//
+//	"readFile", "writeFile" are the UNIX files standing for the
+//		keyboard and the display, or NULL for stdin and stdout
+//----------------------------------------------------------------------
+
+SynchConsole::SynchConsole(char *readFile, char *writeFile)
+{
+    readAvail = new Semaphore("console read avail", 0);
+    writeDone = new Semaphore("console write done", 0);
+    reading = new Semaphore("console reader", 1);
+    writing = new Semaphore("console writer", 1);
+    console = new Console(readFile, writeFile, ConsoleReadAvail,
+				ConsoleWriteDone, (int) this);
+}
+
+SynchConsole::~SynchConsole()
+{
+    delete console;
+    delete readAvail;
+    delete writeDone;
+    delete reading;
+    delete writing;
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::GetChar
+// 	Wait until a character is typed, and return it.
+//----------------------------------------------------------------------
+
+char
+SynchConsole::GetChar()
+{
+    char ch;
+
+    reading->P();
+    readAvail->P();
+    ch = console->GetChar();
+    reading->V();
+    return ch;
+}
+
+//----------------------------------------------------------------------
+// SynchConsole::PutChar
+// 	Write "ch" to the display, and wait until it is done.
+//----------------------------------------------------------------------
+
+void
+SynchConsole::PutChar(char ch)
+{
+    writing->P();
+    console->PutChar(ch);
+    writeDone->P();
+    writing->V();
+}
+
+void
+SynchConsole::ReadAvail()
+{
+    readAvail->V();
+}
+
+void
+SynchConsole::WriteDone()
+{
+    writeDone->V();
+}
@@ -0,0 +1,41 @@
+// synchconsole.h
+//	Data structures to export a synchronous interface to the console
+//	device, for the console system calls.
+//
+//	The console hardware takes one character at a time, and
+//	interrupts when it is done writing it, or when one has been
+//	typed.  Here a thread waiting for the console just sleeps until
+//	then; only one thread reads, and one writes, at a time.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYNCHCONSOLE_H
+#define SYNCHCONSOLE_H
+
+#include "copyright.h"
+#include "console.h"
+#include "synch.h"
+
+class SynchConsole {
+  public:
+    SynchConsole(char *readFile, char *writeFile);
+					// stdin/stdout if NULL
+    ~SynchConsole();
+
+    char GetChar();			// wait for a character to be typed
+    void PutChar(char ch);		// write one, and wait until it is out
+
+    void ReadAvail();			// called by the interrupt handlers
+    void WriteDone();
+
+  private:
+    Console *console;			// the device
+    Semaphore *readAvail;		// a character has been typed
+    Semaphore *writeDone;		// the last one has been written
+    Semaphore *reading;			// one reader at a time
+    Semaphore *writing;			// one writer at a time
+};
+
+#endif // SYNCHCONSOLE_H
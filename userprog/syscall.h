@@ -29,6 +29,10 @@
 #define SC_Close	8
 #define SC_Fork		9
 #define SC_Yield	10
+#define SC_Map		11
+#define SC_Unmap	12
+#define SC_Sbrk		13
+#define SC_Checkpoint	14
 
 #ifndef IN_ASM
 
@@ -55,12 +59,13 @@ void Exit(int status);
 typedef int SpaceId;	
  
 /* Run the executable, stored in the Nachos file "name", and return the 
- * address space identifier
+ * address space identifier (-1 if it cannot be run)
  */
 SpaceId Exec(char *name);
  
 /* Only return once the the user program "id" has finished.  
- * Return the exit status.
+ * Return the exit status (-1 if "id" is not a child of the caller,
+ * or has already been joined).
  */
 int Join(SpaceId id); 	
  
@@ -90,7 +95,7 @@ typedef int OpenFileId;
 void Create(char *name);
 
 /* Open the Nachos file "name", and return an "OpenFileId" that can 
- * be used to read and write to the file.
+ * be used to read and write to the file, or -1 if it cannot be opened.
  */
 OpenFileId Open(char *name);
 
@@ -102,20 +107,51 @@ void Write(char *buffer, int size, OpenFileId id);
  * long enough, or if it is an I/O device, and there aren't enough 
  * characters to read, return whatever is available (for I/O devices, 
  * you should always wait until you can return at least one character).
+ * A read from the console returns at the end of a line.
  */
 int Read(char *buffer, int size, OpenFileId id);
 
 /* Close the file, we're done reading and writing to it. */
 void Close(OpenFileId id);
 
+/* Map all of the Nachos file "name" into the address space, and return
+ * the address of its first byte, or 0 if it cannot be mapped.  Pages are
+ * read from the file as they are referenced, and the ones modified are
+ * written back when they are evicted, or at Unmap or Exit.  The file
+ * does not grow to fit what is stored past its end.
+ */
+char *Map(char *name);
+
+/* Write back and unmap the file mapped at "addr". */
+void Unmap(char *addr);
+
+/* Grow the heap, which starts right after the program's data, by
+ * "increment" bytes (or shrink it, if negative), and return the old end
+ * of the heap.  The new memory is zero filled, and costs nothing until
+ * it is used.  Return -1 if the heap would run into the stack.
+ */
+char *Sbrk(int increment);
+
+/* Save the state of this process (its registers, and the memory it has
+ * modified) to the Nachos file "name", replacing it.  Return 0 once it
+ * is saved, or -1 if it cannot be.  "nachos -restore name" resumes the
+ * process from there, even after Nachos has been restarted, as if
+ * Checkpoint had just returned 1.  Open files are not saved, and a
+ * process that has a file mapped cannot be checkpointed: Unmap it first.
+ */
+int Checkpoint(char *name);
+
 
 
 /* User-level thread operations: Fork and Yield.  To allow multiple
  * threads to run within a user program. 
  */
 
-/* Fork a thread to run a procedure ("func") in the *same* address space 
- * as the current thread.
+/* Fork a new process to run a procedure ("func"), in a copy of the 
+ * address space of the current one.  The copy is made lazily: pages are
+ * shared, copy-on-write, until one of the processes writes to them.
+ * The child starts out with the parent's registers and stack; "func"
+ * should finish by calling Exit.
  */
 void Fork(void (*func)());
 
@@ -0,0 +1,135 @@
+// textcache.cc
+//	Routines to keep track of the executables being run, so that
+//	their code pages can be shared.  See textcache.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "textcache.h"
+
+//----------------------------------------------------------------------
+// SharedText::SharedText
+// 	Start tracking the code of "executable"; none of it is in memory.
+//
+//	"fileName" is the name it was opened by
+//	"pages" is the number of virtual pages holding code
+//----------------------------------------------------------------------
+
+SharedText::SharedText(OpenFile *executable, char *fileName, int pages)
+{
+#ifdef FILESYS_STUB
+    sector = -1;
+    name = new char[strlen(fileName) + 1];
+    strcpy(name, fileName);
+#else
+    sector = executable->HeaderSector();
+    name = NULL;
+#endif
+    users = 1;
+    numPages = pages;
+    frames = new int[pages];
+    for (int i = 0; i < pages; i++)
+	frames[i] = -1;
+    next = NULL;
+}
+
+SharedText::~SharedText()
+{
+    delete [] name;
+    delete [] frames;
+}
+
+//----------------------------------------------------------------------
+// SharedText::IsFile
+// 	Return TRUE if "executable", opened as "fileName", is the file
+//	whose code this is.
+//----------------------------------------------------------------------
+
+bool
+SharedText::IsFile(OpenFile *executable, char *fileName)
+{
+#ifdef FILESYS_STUB
+    return !strcmp(name, fileName);
+#else
+    return sector == executable->HeaderSector();
+#endif
+}
+
+//----------------------------------------------------------------------
+// TextCache::TextCache, TextCache::~TextCache
+//----------------------------------------------------------------------
+
+TextCache::TextCache()
+{
+    texts = NULL;
+}
+
+TextCache::~TextCache()
+{
+    SharedText *text;
+
+    while (texts != NULL) {
+	text = texts;
+	texts = text->next;
+	delete text;
+    }
+}
+
+//----------------------------------------------------------------------
+// TextCache::Attach
+// 	An address space is starting to run "executable": return the
+//	entry for its code, creating it if nobody else is running it.
+//
+//	"fileName" is the name it was opened by
+//	"pages" is the number of virtual pages holding code
+//----------------------------------------------------------------------
+
+SharedText *
+TextCache::Attach(OpenFile *executable, char *fileName, int pages)
+{
+    SharedText *text;
+
+    for (text = texts; text != NULL; text = text->next)
+	if (text->IsFile(executable, fileName)) {
+	    ASSERT(text->numPages == pages);
+	    text->users++;
+	    return text;
+	}
+    text = new SharedText(executable, fileName, pages);
+    text->next = texts;
+    texts = text;
+    return text;
+}
+
+//----------------------------------------------------------------------
+// TextCache::Share
+// 	A child forked from an address space running "text" runs it too.
+//----------------------------------------------------------------------
+
+void
+TextCache::Share(SharedText *text)
+{
+    text->users++;
+}
+
+//----------------------------------------------------------------------
+// TextCache::Detach
+// 	An address space running "text" is going away; forget the text
+//	when it was the last one.
+//----------------------------------------------------------------------
+
+void
+TextCache::Detach(SharedText *text)
+{
+    SharedText **p;
+
+    if (--text->users > 0)
+	return;
+    for (p = &texts; *p != text; p = &(*p)->next)
+	ASSERT(*p != NULL);
+    *p = text->next;
+    delete text;
+}
@@ -0,0 +1,59 @@
+// textcache.h
+//	Data structures to share the code of a program among all the
+//	processes running it.
+//
+//	Pages that hold nothing but code are never modified, so every
+//	address space running the same executable can map the same
+//	frame for them, read-only, instead of reading its own copy.  The
+//	text cache keeps one entry per executable in use, identified by
+//	the disk sector of its file header (with the stub file system,
+//	by its UNIX file name), recording which frame last held each
+//	code page.  The core map checks that the frame still holds the
+//	page before sharing it (see CoreMap::FindSharedText).
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include "copyright.h"
+#include "openfile.h"
+
+// The code of one executable, shared by "users" address spaces
+class SharedText {
+  public:
+    SharedText(OpenFile *executable, char *fileName, int pages);
+    ~SharedText();
+
+    bool IsFile(OpenFile *executable, char *fileName);
+					// is this the text of that file?
+
+    int users;				// address spaces running it
+    int numPages;			// code pages
+    int *frames;			// frame that last held each page,
+					// or -1
+    SharedText *next;			// in the text cache
+
+  private:
+    int sector;				// header sector of the executable
+    char *name;				// or its name, with FILESYS_STUB
+};
+
+class TextCache {
+  public:
+    TextCache();			// no program is running yet
+    ~TextCache();
+
+    SharedText *Attach(OpenFile *executable, char *fileName, int pages);
+					// one more address space runs
+					// "executable", of "pages" code pages
+    void Share(SharedText *text);	// and one more (forked) for "text"
+    void Detach(SharedText *text);	// and one less
+
+  private:
+    SharedText *texts;			// executables in use
+};
+
+#endif // TEXTCACHE_H
@@ -0,0 +1,296 @@
+// tlbmanager.cc
+//	Routines to refill and maintain the software-managed TLB.
+//
+//	The TLB itself (machine->tlb) is part of the simulated hardware;
+//	all the kernel can do is write entries into it.  Here we keep,
+//	for every slot, a pointer to the page table entry it was loaded
+//	from, so that the use and dirty bits the hardware sets in the TLB
+//	can be folded back into the page table before a page is chosen
+//	for replacement or written back to swap.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "tlbmanager.h"
+
+//----------------------------------------------------------------------
+// TLBManager::TLBManager
+// 	Initialize the kernel's view of the TLB.  Every slot starts out
+//	invalid.
+//
+//	"pol" is the policy used to choose the slot to replace on a miss
+//	"tagged" is TRUE if address spaces get their own ASID, FALSE if
+//		the TLB is to be flushed on every context switch
+//----------------------------------------------------------------------
+
+TLBManager::TLBManager(TLBPolicy pol, bool tagged)
+{
+    ASSERT(machine->tlb != NULL);
+    policy = pol;
+    useASIDs = tagged;
+    inverted = (machine->hashAnchor != NULL);
+    hand = 0;
+    source = new TranslationEntry*[tlbSize];
+    for (int i = 0; i < tlbSize; i++)
+	source[i] = NULL;
+    asids = new BitMap(NumASIDs);
+    asids->Mark(0);			// id 0 is shared by untagged spaces
+}
+
+//----------------------------------------------------------------------
+// TLBManager::~TLBManager
+// 	De-allocate the kernel's view of the TLB.
+//----------------------------------------------------------------------
+
+TLBManager::~TLBManager()
+{
+    delete [] source;
+    delete asids;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::FindVictim
+// 	Choose the TLB slot to load a new translation into.  An invalid
+//	slot is always used first.
+//----------------------------------------------------------------------
+
+int
+TLBManager::FindVictim()
+{
+    int i;
+
+    for (i = 0; i < tlbSize; i++)
+	if (!machine->tlb[i].valid)
+	    return i;
+
+    switch (policy) {
+      case TLBRandom:
+	return Random() % tlbSize;
+
+      case TLBClock:
+	// give every recently used slot a second chance, clearing its
+	// use bit (after saving it in the page table) as we pass by
+	while (machine->tlb[hand].use) {
+	    SyncSlot(hand);
+	    machine->tlb[hand].use = FALSE;
+	    hand = (hand + 1) % tlbSize;
+	}
+	break;
+
+      case TLBFifo:
+	break;
+    }
+    i = hand;
+    hand = (hand + 1) % tlbSize;
+    return i;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Drop
+// 	Write back the bits of one TLB slot, and invalidate it.
+//----------------------------------------------------------------------
+
+void
+TLBManager::Drop(int slot)
+{
+    TranslationEntry *entry = &machine->tlb[slot];
+
+    if (entry->valid) {
+	SyncSlot(slot);
+	if (inverted)
+	    Unchain(slot);
+	entry->valid = FALSE;
+    }
+    source[slot] = NULL;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::SyncSlot
+// 	OR the use and dirty bits of a valid TLB slot into the page table
+//	entries it was loaded from.  The hardware does not tell which
+//	pages of a superpage were used, so they all get the bits.
+//----------------------------------------------------------------------
+
+void
+TLBManager::SyncSlot(int slot)
+{
+    TranslationEntry *entry = &machine->tlb[slot];
+
+    for (int i = 0; i < entry->pages; i++) {
+	source[slot][i].use |= entry->use;
+	source[slot][i].dirty |= entry->dirty;
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Chain, TLBManager::Unchain
+// 	Add the (valid) entry in "slot" of the inverted page table to
+//	the head of its hash chain, or take it off.
+//----------------------------------------------------------------------
+
+void
+TLBManager::Chain(int slot)
+{
+    TranslationEntry *entry = &machine->tlb[slot];
+    int bucket = IptHash(entry->virtualPage, entry->asid, machine->hashSize);
+
+    machine->hashNext[slot] = machine->hashAnchor[bucket];
+    machine->hashAnchor[bucket] = slot;
+}
+
+void
+TLBManager::Unchain(int slot)
+{
+    TranslationEntry *entry = &machine->tlb[slot];
+    int *link = &machine->hashAnchor[IptHash(entry->virtualPage,
+					entry->asid, machine->hashSize)];
+
+    while (*link != slot) {
+	ASSERT(*link != -1);
+	link = &machine->hashNext[*link];
+    }
+    *link = machine->hashNext[slot];
+    machine->hashNext[slot] = -1;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Refill
+// 	Handle a TLB miss, by copying the (valid) page table entry
+//	into the TLB.
+//
+//	In an inverted page table, the slot is the page's frame.
+//
+//	"entry" is the page table entry of the page that missed, or the
+//		first entry of its superpage
+//	"asid" is the address space id of the page table
+//	"pages" is the size of the superpage, or 1
+//----------------------------------------------------------------------
+
+void
+TLBManager::Refill(TranslationEntry *entry, int asid, int pages)
+{
+    int slot = inverted ? entry->physicalPage : FindVictim();
+
+    ASSERT(entry->valid && (pages == 1 || !inverted));
+    Drop(slot);
+    machine->tlb[slot] = *entry;
+    machine->tlb[slot].asid = asid;
+    machine->tlb[slot].pages = pages;
+    machine->tlb[slot].use = FALSE;	// bits are accumulated in the
+    machine->tlb[slot].dirty = FALSE;	// page table
+    source[slot] = entry;
+    if (inverted)
+	Chain(slot);
+    DEBUG('a', "TLB slot %d <- vpn %d, frame %d, asid %d, %d pages\n",
+		slot, entry->virtualPage, entry->physicalPage, asid, pages);
+}
+
+//----------------------------------------------------------------------
+// TLBManager::SyncBits
+// 	Move the use and dirty bits set by the hardware into the page
+//	tables, so the kernel sees them when it chooses a victim page.
+//	The bits are cleared in the TLB, so that a page replacement
+//	algorithm can clear the use bit in the page table.
+//----------------------------------------------------------------------
+
+void
+TLBManager::SyncBits()
+{
+    for (int i = 0; i < tlbSize; i++) {
+	TranslationEntry *entry = &machine->tlb[i];
+
+	if (!entry->valid)
+	    continue;
+	SyncSlot(i);
+	entry->use = entry->dirty = FALSE;
+    }
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Invalidate
+// 	A page table entry is about to become invalid (its page is being
+//	evicted); make sure the TLB does not keep a stale copy of it.
+//	In an inverted page table, it can only be in its frame's slot.
+//	A superpage slot goes if any of its pages does: what is left of
+//	the superpage is mapped page by page from then on.
+//----------------------------------------------------------------------
+
+void
+TLBManager::Invalidate(TranslationEntry *entry)
+{
+    if (inverted) {
+	int slot = entry->physicalPage;
+
+	if (slot >= 0 && slot < tlbSize && source[slot] == entry)
+	    Drop(slot);
+	return;
+    }
+    for (int i = 0; i < tlbSize; i++)
+	if (source[i] != NULL && entry >= source[i]
+		&& entry < source[i] + machine->tlb[i].pages)
+	    Drop(i);
+}
+
+//----------------------------------------------------------------------
+// TLBManager::Flush
+// 	Invalidate the whole TLB.
+//----------------------------------------------------------------------
+
+void
+TLBManager::Flush()
+{
+    for (int i = 0; i < tlbSize; i++)
+	Drop(i);
+}
+
+//----------------------------------------------------------------------
+// TLBManager::SwitchTo
+// 	Called on a context switch to a user program.  With ASIDs we only
+//	have to load the id register; otherwise (or if the address space
+//	did not get an id of its own) the entries of the previous address
+//	space have to go.
+//----------------------------------------------------------------------
+
+void
+TLBManager::SwitchTo(int asid)
+{
+    if (asid == 0 || machine->asid == 0 || !useASIDs)
+	Flush();
+    machine->asid = asid;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::AllocASID
+// 	Return a new address space id, or 0 if the TLB is not tagged or
+//	all the ids are in use.
+//----------------------------------------------------------------------
+
+int
+TLBManager::AllocASID()
+{
+    int asid;
+
+    if (!useASIDs)
+	return 0;
+    asid = asids->Find();
+    return (asid == -1) ? 0 : asid;
+}
+
+//----------------------------------------------------------------------
+// TLBManager::FreeASID
+// 	An address space is going away; invalidate its entries, which
+//	point into its page table, and recycle its id.
+//----------------------------------------------------------------------
+
+void
+TLBManager::FreeASID(int asid)
+{
+    for (int i = 0; i < tlbSize; i++)
+	if (source[i] != NULL && machine->tlb[i].asid == asid)
+	    Drop(i);
+    if (asid != 0)
+	asids->Clear(asid);
+}
@@ -0,0 +1,89 @@
+// tlbmanager.h
+//	Data structures for the kernel side of a software-managed TLB.
+//
+//	When the machine has a TLB (see "-tlb"), the hardware only knows
+//	about the few translations loaded in machine->tlb; any other
+//	reference traps to the kernel with a PageFaultException.  The
+//	kernel then looks the page up in the page table of the running
+//	address space (paging it in first, if needed) and loads the
+//	translation into a TLB slot, choosing which slot to replace with
+//	one of the policies below.
+//
+//	The hardware only sets the use and dirty bits of the TLB entry,
+//	so we remember which page table entry each slot was loaded from,
+//	and copy the bits back before the kernel looks at the page table.
+//
+//	A superpage (see "-super") is loaded into a single slot, which
+//	stands for the page table entries of all its pages: they are
+//	next to each other in the same second-level table.
+//
+//	Each address space gets an address space id (ASID) which tags
+//	its TLB entries, so that a context switch does not need to flush
+//	the TLB.  With "-tlbflush", or when we run out of ids, the TLB is
+//	flushed on every context switch instead.
+//
+//	With "-ipt", the TLB becomes a hashed inverted page table: it has
+//	an entry per physical page frame, and the translation of the page
+//	in a frame is always loaded into that frame's entry, so nothing
+//	is ever replaced but stale translations.  The kernel links each
+//	loaded entry onto its hash chain, which the hardware follows to
+//	translate an address.  A frame shared by several address spaces
+//	can only be mapped by one of them at a time.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef TLBMANAGER_H
+#define TLBMANAGER_H
+
+#include "copyright.h"
+#include "translate.h"
+#include "bitmap.h"
+
+#define NumASIDs	64	// address space ids; id 0 is untagged, and
+				// is flushed on every switch
+
+// Which TLB slot to replace on a miss
+enum TLBPolicy { TLBFifo,		// round robin over the slots
+		 TLBRandom,		// any slot
+		 TLBClock		// second chance, using the use bit
+};
+
+class TLBManager {
+  public:
+    TLBManager(TLBPolicy pol, bool tagged);	// set up the kernel side
+    ~TLBManager();				// of the TLB
+
+    void Refill(TranslationEntry *entry, int asid, int pages);
+				// load the translation for "entry"
+				// (in the page table of "asid"), and
+				// the "pages" - 1 entries after it
+    void SyncBits();		// move the use/dirty bits from the TLB
+				// back into the page tables
+    void Invalidate(TranslationEntry *entry);
+				// drop the slot loaded from "entry", if
+				// any, e.g. because its page was evicted
+    void Flush();		// drop every slot
+    void SwitchTo(int asid);	// on a context switch, make "asid" the
+				// running address space
+
+    int AllocASID();		// get an id for a new address space
+    void FreeASID(int asid);	// drop the slots of a dying address space
+
+  private:
+    int FindVictim();		// pick the slot to replace
+    void Drop(int slot);	// sync and invalidate one slot
+    void SyncSlot(int slot);	// copy its bits back to the page table
+    void Chain(int slot);	// inverted page table: hash chains
+    void Unchain(int slot);
+
+    TLBPolicy policy;
+    bool inverted;		// one slot per frame, found by hashing
+    bool useASIDs;		// FALSE => flush on every context switch
+    TranslationEntry **source;	// page table entry each slot came from
+    int hand;			// next slot, for FIFO and clock
+    BitMap *asids;		// address space ids in use
+};
+
+#endif // TLBMANAGER_H
@@ -0,0 +1,103 @@
+// usermem.cc
+//	Routines to work on user buffers a page at a time.  See usermem.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "usermem.h"
+
+//----------------------------------------------------------------------
+// UserTransfer
+// 	Run "func" over the user buffer of "size" bytes at virtual address
+//	"addr" of the current address space, one page at a time.  Each
+//	page is pinned in memory while "func" works on it, since "func"
+//	may block (on the disk, or the console), and let the pageout
+//	daemon or another process run.
+//
+//	Return the number of bytes "func" did, or -1 if the buffer
+//	starts outside the address space (or in code, when "writing").
+//	A buffer that runs off the end is cut short there.
+//
+//	"writing" is TRUE if "func" writes into the buffer
+//	"arg" is passed on to "func"
+//----------------------------------------------------------------------
+
+int
+UserTransfer(int addr, int size, bool writing, ChunkFunction func, int arg)
+{
+    AddrSpace *space = currentThread->space;
+    int done = 0, vaddr, count, moved, frame;
+
+    if (addr < 0 || size < 0)
+	return -1;
+    while (done < size) {
+	vaddr = addr + done;
+	count = PageSize - vaddr % PageSize;	// the rest of this page
+	if (count > size - done)
+	    count = size - done;
+	frame = coreMap->Pin(space, vaddr / PageSize, writing);
+	if (frame == -1)
+	    return (done > 0) ? done : -1;
+	moved = (*func)(&(machine->mainMemory[frame * PageSize
+					      + vaddr % PageSize]), count, arg);
+	coreMap->Unpin(frame);
+	done += moved;
+	if (moved < count)
+	    break;
+    }
+    return done;
+}
+
+// Where ReadUserString is copying to
+class StringCopy {
+  public:
+    char *into;				// the next character goes here
+    int left;				// room left
+    bool ended;				// the NUL has been copied
+};
+
+//----------------------------------------------------------------------
+// CopyString
+// 	Copy characters of a user string until the NUL, or until there
+//	is no more room.
+//
+//	"arg" is the StringCopy
+//----------------------------------------------------------------------
+
+static int
+CopyString(char *chunk, int count, int arg)
+{
+    StringCopy *s = (StringCopy *) arg;
+    int i;
+
+    for (i = 0; i < count && s->left > 0 && !s->ended; i++) {
+	*(s->into)++ = chunk[i];
+	s->left--;
+	s->ended = (chunk[i] == '\0');
+    }
+    return s->ended ? 0 : i;
+}
+
+//----------------------------------------------------------------------
+// ReadUserString
+// 	Copy the string at virtual address "addr" of the current address
+//	space into the kernel buffer "into", of "size" bytes.
+//
+//	Return FALSE if the string is not in the address space, or does
+//	not fit.
+//----------------------------------------------------------------------
+
+bool
+ReadUserString(int addr, char *into, int size)
+{
+    StringCopy s;
+
+    s.into = into;
+    s.left = size;
+    s.ended = FALSE;
+    UserTransfer(addr, size, FALSE, CopyString, (int) &s);
+    return s.ended;
+}
@@ -0,0 +1,36 @@
+// usermem.h
+//	Routines to move the buffers of system calls between user memory
+//	and the kernel.
+//
+//	A user buffer is handled a page at a time: each page is
+//	translated once, brought into memory (or copied, if it is
+//	copy-on-write and is to be written) and pinned in its frame, and
+//	the part of the buffer in it is handed to a routine that works
+//	on it in place, in physical memory.  So file data moves straight
+//	between the file and the user's pages, with no kernel buffer in
+//	between, and no per-byte call to Machine::ReadMem or WriteMem.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef USERMEM_H
+#define USERMEM_H
+
+#include "copyright.h"
+
+#define UserStringMax	128	// longest file name a user program passes
+
+// Works on "count" bytes of a user buffer, at "chunk" in physical
+// memory; returns how many it did, less than "count" to stop early
+typedef int (*ChunkFunction)(char *chunk, int count, int arg);
+
+extern int UserTransfer(int addr, int size, bool writing,
+			ChunkFunction func, int arg);
+					// run "func" over the user buffer;
+					// return the bytes done, or -1 if
+					// the buffer is not ours
+extern bool ReadUserString(int addr, char *into, int size);
+					// copy a NUL terminated string in
+
+#endif // USERMEM_H
@@ -0,0 +1,311 @@
+// refsim.cc
+//	Page replacement simulator.  Replays a page reference string,
+//	recorded by running Nachos with "-rtrace", against every policy
+//	in userprog/replace.cc, and against Belady's optimal policy
+//	(evict the page whose next reference is furthest in the future),
+//	for a range of memory sizes.
+//
+//	Usage: refsim <trace file> [<min frames> [<max frames> [<step>]]]
+//
+//	The fault counts are printed as CSV, one line per number of
+//	frames and one column per policy, ready to be plotted.  By
+//	default the frame counts go from 1 to the number of distinct
+//	pages in the trace, where every policy only takes cold misses.
+//
+//	The simulated kernel behaves like the real one: a page brought
+//	in starts with clear use and dirty bits, every reference sets
+//	them, and free frames are used before any page is evicted.  The
+//	processes in the trace share the frames, under global
+//	replacement; each has its own pages, whose frames are freed when
+//	it goes away.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "utility.h"
+#include "replace.h"
+#include "reftrace.h"
+
+// UNIX routines used here, declared like the ones in sysdep.cc
+extern "C" {
+void abort();
+void exit(int);
+}
+
+static int *refs;		// the reference string, without repeats,
+				// with the pages numbered across all
+				// processes; or RefExitFlag | process
+static int *repeats;		// times each of them was repeated
+static int numRefs;
+static int numPages;		// pages referenced by all processes
+static int *spaceOf;		// process each page belongs to
+static int numSpaces;		// processes, numbered as they appear
+static int *nextRef;		// for each reference, where its page is
+				// referenced next (numRefs if never)
+
+// The policies use ASSERT, which calls the kernel's Abort
+void
+Abort()
+{
+    abort();
+}
+
+//----------------------------------------------------------------------
+// FromLittleEndian
+// 	Convert a word of the trace file to host byte order.
+//----------------------------------------------------------------------
+
+static int
+FromLittleEndian(int word)
+{
+#ifdef HOST_IS_BIG_ENDIAN
+    unsigned int w = word;
+
+    return (w >> 24) | ((w >> 8) & 0xff00) | ((w << 8) & 0xff0000)
+		| (w << 24);
+#else
+    return word;
+#endif
+}
+
+//----------------------------------------------------------------------
+// ReadTrace
+// 	Load the whole reference string of "fileName" into memory, and
+//	compute for every reference when its page is next used (which
+//	is all the optimal policy needs to know about the future).  A
+//	run of identical references is kept as one, with its number of
+//	repeats.
+//
+//	The pages are numbered anew, so that each virtual page of each
+//	process is a page of its own.  A process that goes away takes
+//	its pages with it: a later one with the same SpaceId gets new
+//	ones.
+//----------------------------------------------------------------------
+
+static void
+ReadTrace(char *fileName)
+{
+    FILE *f = fopen(fileName, "rb");
+    int header[2], *last, i, words, total = 0;
+    int maxPid = 0, maxVpn = 0, pid = 0;
+    int **pageIds, *spaceIds;		// for each SpaceId in use: the
+					// number of each of its pages, and
+					// the number of the process
+    long size;
+
+    if (f == NULL) {
+	perror(fileName);
+	exit(1);
+    }
+    if (fread(header, sizeof(int), 2, f) != 2
+		|| FromLittleEndian(header[0]) != RefTraceMagic) {
+	fprintf(stderr, "%s is not a page reference trace\n", fileName);
+	exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 2 * sizeof(int), SEEK_SET);
+    words = (size / sizeof(int)) - 2;
+    refs = new int[words];
+    repeats = new int[words];
+    spaceOf = new int[words];
+    words = fread(refs, sizeof(int), words, f);
+    fclose(f);
+
+    for (i = 0; i < words; i++) {
+	int word = FromLittleEndian(refs[i]);
+
+	if (RefIsSwitch(word) || RefIsExit(word))
+	    maxPid = max(maxPid, RefPid(word));
+	else if (!RefIsRepeat(word))
+	    maxVpn = max(maxVpn, (int) RefPage(word));
+    }
+    pageIds = new int*[maxPid + 1];
+    spaceIds = new int[maxPid + 1];
+    for (i = 0; i <= maxPid; i++)
+	pageIds[i] = NULL;
+
+    numRefs = numPages = numSpaces = 0;
+    for (i = 0; i < words; i++) {
+	int word = FromLittleEndian(refs[i]), vpn;
+
+	if (RefIsRepeat(word)) {
+	    if (numRefs > 0)		// no reference to repeat otherwise
+		repeats[numRefs - 1] += RefRepeats(word);
+	    continue;
+	}
+	if (RefIsSwitch(word)) {
+	    pid = RefPid(word);
+	    continue;
+	}
+	if (RefIsExit(word)) {
+	    if (pageIds[RefPid(word)] != NULL) {
+		refs[numRefs] = RefExitFlag | spaceIds[RefPid(word)];
+		repeats[numRefs++] = 0;
+		delete [] pageIds[RefPid(word)];
+		pageIds[RefPid(word)] = NULL;
+	    }
+	    continue;
+	}
+	if (pageIds[pid] == NULL) {	// the first reference of a process
+	    pageIds[pid] = new int[maxVpn + 1];
+	    for (vpn = 0; vpn <= maxVpn; vpn++)
+		pageIds[pid][vpn] = -1;
+	    spaceIds[pid] = numSpaces++;
+	}
+	vpn = RefPage(word);
+	if (pageIds[pid][vpn] == -1) {
+	    spaceOf[numPages] = spaceIds[pid];
+	    pageIds[pid][vpn] = numPages++;
+	}
+	refs[numRefs] = RefWord(pageIds[pid][vpn], RefIsWrite(word));
+	repeats[numRefs++] = 0;
+    }
+    for (i = 0; i <= maxPid; i++)
+	delete [] pageIds[i];
+    delete [] pageIds;
+    delete [] spaceIds;
+    for (i = 0; i < numRefs; i++)
+	if (!RefIsExit(refs[i]))
+	    total += 1 + repeats[i];
+
+    nextRef = new int[numRefs];
+    last = new int[numPages];
+    for (i = 0; i < numPages; i++)
+	last[i] = numRefs;
+    for (i = numRefs - 1; i >= 0; i--)
+	if (!RefIsExit(refs[i])) {
+	    nextRef[i] = last[RefPage(refs[i])];
+	    last[RefPage(refs[i])] = i;
+	}
+    delete [] last;
+    fprintf(stderr, "%s: %d references to %d pages of %d bytes, "
+	    "by %d processes\n", fileName, total, numPages,
+	    FromLittleEndian(header[1]), numSpaces);
+}
+
+//----------------------------------------------------------------------
+// Simulate
+// 	Replay the trace with "frames" page frames, and return the
+//	number of page faults.
+//
+//	"policyName" is one of replacementPolicies, or "opt"
+//----------------------------------------------------------------------
+
+static int
+Simulate(char *policyName, int frames)
+{
+    ReplacementPolicy *policy = NULL;
+    TranslationEntry *pages = new TranslationEntry[numPages];
+    int *due = new int[frames];		// opt: next use of each frame,
+    TranslationEntry **owner = new TranslationEntry*[frames];	// and page
+    int *freed = new int[frames];	// frames given back by processes
+    int used = 0, numFreed = 0, faults = 0;
+    int i, frame;
+
+    if (strcmp(policyName, "opt"))
+	policy = NewReplacementPolicy(policyName, frames);
+    for (i = 0; i < numPages; i++) {
+	pages[i].virtualPage = i;
+	pages[i].valid = FALSE;
+    }
+
+    for (i = 0; i < numRefs; i++) {
+	TranslationEntry *entry;
+	bool writing = RefIsWrite(refs[i]);
+
+	if (RefIsExit(refs[i])) {	// free the frames of the process
+	    for (frame = 0; frame < used; frame++)
+		if (owner[frame] != NULL
+			&& spaceOf[owner[frame]->virtualPage]
+						== RefPid(refs[i])) {
+		    owner[frame]->valid = FALSE;
+		    owner[frame] = NULL;
+		    if (policy != NULL)
+			policy->Freed(frame);
+		    freed[numFreed++] = frame;
+		}
+	    continue;
+	}
+	entry = &pages[RefPage(refs[i])];
+	if (!entry->valid) {
+	    faults++;
+	    if (numFreed > 0)
+		frame = freed[--numFreed];
+	    else if (used < frames)
+		frame = used++;
+	    else if (policy != NULL) {
+		frame = policy->SelectVictim();
+		policy->PageIn(frame)->valid = FALSE;
+	    } else {
+		frame = 0;
+		for (int j = 1; j < frames; j++)
+		    if (due[j] > due[frame])
+			frame = j;
+		owner[frame]->valid = FALSE;
+	    }
+	    entry->physicalPage = frame;
+	    entry->valid = TRUE;
+	    entry->use = entry->dirty = FALSE;
+	    if (policy != NULL)
+		policy->Loaded(frame, entry);
+	    owner[frame] = entry;
+	}
+	for (int r = 0; r <= repeats[i]; r++) {	// the repeats only hit
+	    entry->use = TRUE;
+	    if (writing)
+		entry->dirty = TRUE;
+	    if (policy != NULL)
+		policy->Referenced(entry->physicalPage, writing);
+	}
+	if (policy == NULL)
+	    due[entry->physicalPage] = nextRef[i];
+    }
+
+    delete policy;
+    delete [] pages;
+    delete [] due;
+    delete [] owner;
+    delete [] freed;
+    return faults;
+}
+
+int
+main(int argc, char **argv)
+{
+    int minFrames = 1, maxFrames, step = 1;
+    int p;
+
+    if (argc < 2) {
+	fprintf(stderr, "Usage: %s <trace file> [<min frames> "
+		"[<max frames> [<step>]]]\n", argv[0]);
+	exit(1);
+    }
+    ReadTrace(argv[1]);
+    maxFrames = numPages;
+    if (argc > 2)
+	minFrames = atoi(argv[2]);
+    if (argc > 3)
+	maxFrames = atoi(argv[3]);
+    if (argc > 4)
+	step = atoi(argv[4]);
+    if (minFrames < 1 || step < 1) {
+	fprintf(stderr, "%s: frame counts must be positive\n", argv[0]);
+	exit(1);
+    }
+
+    printf("frames,opt");
+    for (p = 0; replacementPolicies[p] != NULL; p++)
+	printf(",%s", replacementPolicies[p]);
+    printf("\n");
+    for (int frames = minFrames; frames <= maxFrames; frames += step) {
+	printf("%d,%d", frames, Simulate("opt", frames));
+	for (p = 0; replacementPolicies[p] != NULL; p++)
+	    printf(",%d", Simulate(replacementPolicies[p], frames));
+	printf("\n");
+	fflush(stdout);
+    }
+    return 0;
+}